@@ -147,6 +147,24 @@ namespace Astroid {
       default_account = 0;
       accounts[0].isdefault = true;
     }
+
+    for (unsigned int i = 0; i < accounts.size (); i++) {
+      Account &a = accounts[i];
+      own_addresses.emplace (normalize (Address (a.name, a.email).email ()), i);
+    }
+  }
+
+  std::string AccountManager::normalize (ustring email) {
+    ustring e = email.lowercase ();
+    UstringUtils::trim (e);
+    return e;
+  }
+
+  int AccountManager::find_own (Address &a) {
+    auto f = own_addresses.find (normalize (a.email ()));
+
+    if (f == own_addresses.end ()) return -1;
+    else return f->second;
   }
 
   Account * AccountManager::get_account_for_address (ustring address) {
@@ -155,10 +173,10 @@ namespace Astroid {
   }
 
   Account * AccountManager::get_account_for_address (Address address) {
-    for (auto &a : accounts) {
-      if (a == address) {
-        return &a;
-      }
+    int i = find_own (address);
+
+    if (i >= 0) {
+      return &(accounts[i]);
     }
 
     LOG (error) << "ac: error: could not figure out which account: " << address.full_address() << " belongs to.";
@@ -170,30 +188,62 @@ namespace Astroid {
   }
 
   bool AccountManager::is_me (Address &a) {
-    for (Account &ac : accounts) {
-      if (ac == a) return true;
+    return find_own (a) >= 0;
+  }
+
+  Account * AccountManager::get_assosciated_account (refptr<Message> msg) {
+    if (msg->mid.empty ()) return &(accounts[resolve (msg)]);
+
+    auto r = resolved.find (msg->mid);
+
+    if (r != resolved.end () && r->second.tags == msg->tags) {
+      return &(accounts[r->second.account]);
     }
 
-    return false;
+    if (resolved.size () >= MAX_RESOLVED) resolved.clear ();
+
+    int i = resolve (msg);
+    resolved[msg->mid] = { msg->tags, i };
+
+    return &(accounts[i]);
   }
 
-  Account * AccountManager::get_assosciated_account (refptr<Message> msg) {
+  int AccountManager::resolve (refptr<Message> msg) {
     /* look for any accounts involved in message */
     for (Address &a : msg->all_to_from().addresses) {
-      if (is_me (a)) {
+      int i = find_own (a);
+      if (i >= 0) {
         LOG (debug) << "ac: found address involved in conversation: " << a.full_address ();
-        return get_account_for_address (a);
+        return i;
       }
     }
 
     /* look for account with query containing message */
     if (msg->in_notmuch) {
-      Db db;
-      for (Account &a : accounts) {
-        if (!a.select_query.empty ()) {
-          if (msg->nmmsg->in_query (&db, a.select_query)) {
-            LOG (debug) << "ac: found address matching query: " << a.full_address ();
-            return &a;
+      std::vector<int> candidates;
+      ustring any;
+
+      for (unsigned int i = 0; i < accounts.size (); i++) {
+        if (!accounts[i].select_query.empty ()) {
+          candidates.push_back (i);
+          any += ustring (any.empty () ? "" : " OR ") + "(" + accounts[i].select_query + ")";
+        }
+      }
+
+      if (!candidates.empty ()) {
+        Db db;
+
+        /* one query for all accounts, only when it matches do the
+         * accounts need to be told apart */
+        if (db.message_in_query (any, msg->mid)) {
+          for (unsigned int k = 0; k < candidates.size (); k++) {
+            Account &a = accounts[candidates[k]];
+
+            if (k == candidates.size () - 1 ||
+                db.message_in_query (a.select_query, msg->mid)) {
+              LOG (debug) << "ac: found address matching query: " << a.full_address ();
+              return candidates[k];
+            }
           }
         }
       }
@@ -202,7 +252,7 @@ namespace Astroid {
     LOG (debug) << "ac: could not find associated address, using default.";
 
     /* no matching account found, use default */
-    return &(accounts[default_account]);
+    return default_account;
   }
 
   /* --------
@@ -1,6 +1,8 @@
 # pragma once
 
 # include <vector>
+# include <map>
+# include <unordered_map>
 # include <boost/filesystem.hpp>
 
 # include "astroid.hh"
@@ -56,6 +58,24 @@ namespace Astroid {
       Account * get_assosciated_account (refptr<Message>);
 
       bool is_me (Address &);
+
+    private:
+      /* normalized own addresses to index in accounts */
+      std::unordered_map<std::string, int> own_addresses;
+      static std::string normalize (ustring email);
+      int find_own (Address &);
+
+      /* resolved accounts by message id, the entry is only valid as long
+       * as the tags of the message are unchanged */
+      struct Resolved {
+        std::vector<ustring> tags;
+        int account;
+      };
+
+      std::map<ustring, Resolved> resolved;
+      static const size_t MAX_RESOLVED = 1000;
+
+      int resolve (refptr<Message>);
   };
 }
 
@@ -31,11 +31,14 @@
 # include "db.hh"
 # include "config.hh"
 # include "account_manager.hh"
+# include "crypto.hh"
 # include "actions/action_manager.hh"
 # include "actions/action.hh"
 # include "utils/date_utils.hh"
 # include "utils/utils.hh"
 # include "utils/resource.hh"
+# include "utils/filter_process.hh"
+# include "utils/startup_profile.hh"
 
 # ifndef DISABLE_PLUGINS
   # include "plugin/manager.hh"
@@ -48,6 +51,10 @@
 # include "modes/thread_index/thread_index.hh"
 # include "modes/edit_message.hh"
 # include "modes/saved_searches.hh"
+# include "modes/thread_view/theme.hh"
+# include "modes/thread_view/thread_view_pool.hh"
+# include "modes/thread_index/thread_prefetcher.hh"
+# include "modes/thread_view/webextension/ae_protocol.hh"
 
 /* gmime */
 # include <gmime/gmime.h>
@@ -107,6 +114,8 @@ namespace Astroid {
     Gtk::Application("org.astroid",
         Gio::APPLICATION_HANDLES_OPEN | Gio::APPLICATION_HANDLES_COMMAND_LINE)
   {
+    StartupProfile::begin ();
+
     setlocale (LC_ALL, "");
     Glib::init ();
 
@@ -132,6 +141,7 @@ namespace Astroid {
       ( "start-polling",  "indicate that external polling (external notmuch db R/W operations) starts")
       ( "stop-polling",   "indicate that external polling stops")
       ( "refresh", po::value<unsigned long>(), "refresh messages changed since lastmod")
+      ( "startup-profile", "print time spent in each startup phase")
 # ifndef DISABLE_PLUGINS
       ( "disable-plugins", "disable plugins");
 # else
@@ -140,6 +150,8 @@ namespace Astroid {
 
       /* default option (without --<option> prefix) */
     pdesc.add("mailto", -1);
+
+    StartupProfile::phase ("glib and gmime");
   }
   // }}}
 
@@ -167,6 +179,7 @@ namespace Astroid {
 
     show_help |= vm.count("help");
     bool test_config = vm.count("test-config");
+    StartupProfile::print = vm.count ("startup-profile");
 
     if (show_help) {
 
@@ -241,6 +254,8 @@ namespace Astroid {
         }
       }
 
+      StartupProfile::phase ("config");
+
       /* setting up loggers */
       if (config ("astroid.log").get<bool>("stdout") && !vm.count ("log-stdout")) {
         init_console_log ();
@@ -281,6 +296,8 @@ namespace Astroid {
 
       _hint_level = config ("astroid.hints").get<int> ("level");
 
+      StartupProfile::phase ("logging");
+
       /* set up classes */
       Date::init ();
       Utils::init ();
@@ -301,17 +318,23 @@ namespace Astroid {
         return 1;
       }
 
+      StartupProfile::phase ("database");
+
       Keybindings::init ();
       SavedSearches::init ();
 
       /* set up accounts */
       accounts = new AccountManager ();
 
+      StartupProfile::phase ("keybindings and accounts");
+
 # ifndef DISABLE_PLUGINS
       /* set up plugins */
       bool disable_plugins = vm.count ("disable-plugins");
       plugin_manager = new PluginManager (disable_plugins, in_test ());
       plugin_manager->astroid_extension = new PluginManager::AstroidExtension (this);
+
+      StartupProfile::phase ("plugins");
 # endif
 
       /* set up global actions */
@@ -326,6 +349,21 @@ namespace Astroid {
       }
       poll = new Poll (!no_auto_poll);
 
+      /* compile the thread view theme while the first window is set up */
+      Theme::preload ();
+
+      StartupProfile::phase ("actions, poll and filters");
+
+      quote_processor = new FilterProcess ("quote",
+          config ().get<string> ("mail.reply.quote_processor"),
+          config ().get<string> ("mail.reply.quote_processor_persistent"),
+          config ().get<int> ("mail.reply.quote_processor_timeout"));
+
+      markdown_processor = new FilterProcess ("markdown",
+          config ().get<string> ("editor.markdown_processor"),
+          config ().get<string> ("editor.markdown_processor_persistent"),
+          config ().get<int> ("editor.markdown_processor_timeout"));
+
       Gtk::Application::run (argc, argv);
 
       on_quit ();
@@ -386,6 +424,16 @@ namespace Astroid {
 
     /* set up poller */
     poll = new Poll (false);
+
+    quote_processor = new FilterProcess ("quote",
+        config ().get<string> ("mail.reply.quote_processor"),
+        config ().get<string> ("mail.reply.quote_processor_persistent"),
+        config ().get<int> ("mail.reply.quote_processor_timeout"));
+
+    markdown_processor = new FilterProcess ("markdown",
+        config ().get<string> ("editor.markdown_processor"),
+        config ().get<string> ("editor.markdown_processor_persistent"),
+        config ().get<int> ("editor.markdown_processor_timeout"));
   } // }}}
 
   bool Astroid::in_test () {
@@ -399,9 +447,21 @@ namespace Astroid {
     if (poll) poll->close ();
 
     if (actions) actions->close ();
+    if (quote_processor) quote_processor->close ();
+    if (markdown_processor) markdown_processor->close ();
     SavedSearches::destruct ();
 
+    ThreadViewPool::clear ();
+    ThreadPrefetcher::clear ();
+    Theme::wait_preload ();
+
+    /* drop decrypted content */
+    Crypto::cache_clear ();
+
+    AeProtocol::log_stats ();
+
 # ifndef DISABLE_PLUGINS
+    if (plugin_manager) plugin_manager->log_hook_stats ();
     if (plugin_manager && plugin_manager->astroid_extension) delete plugin_manager->astroid_extension;
     if (plugin_manager) delete plugin_manager;
 # endif
@@ -423,6 +483,9 @@ namespace Astroid {
       actions->close ();
       delete actions;
     }
+
+    if (quote_processor) delete quote_processor;
+    if (markdown_processor) delete markdown_processor;
   }
 
   int Astroid::on_command_line (const refptr<Gio::ApplicationCommandLine> & cmd) {
@@ -558,6 +621,8 @@ namespace Astroid {
     add_window (*mw);
     mw->show_all ();
 
+    StartupProfile::phase ("window");
+
     return mw;
   }
 
@@ -572,6 +637,7 @@ namespace Astroid {
 
   void Astroid::on_activate () {
     open_new_window ();
+    ThreadViewPool::fill ();
   }
 
   void Astroid::send_mailto (ustring uri) {
@@ -75,6 +75,10 @@ namespace Astroid {
       /* poll */
       Poll * poll = NULL;
 
+      /* html to text for quoting, markdown to html for composing */
+      FilterProcess * quote_processor = NULL;
+      FilterProcess * markdown_processor = NULL;
+
       MainWindow * open_new_window (bool open_defaults = true);
 
       int hint_level ();
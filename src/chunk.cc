@@ -2,6 +2,7 @@
 # include <iostream>
 # include <atomic>
 # include <fstream>
+# include <fcntl.h>
 
 # include <boost/filesystem.hpp>
 
@@ -24,9 +25,12 @@ namespace Astroid {
 
   std::atomic<uint> Chunk::nextid (0);
 
-  Chunk::Chunk (GMimeObject * mp, bool encrypted, bool _signed, refptr<Crypto> _cr) : mime_object (mp) {
+  Chunk::Chunk (GMimeObject * mp, bool encrypted, bool _signed, refptr<Crypto> _cr, ustring _mid, ustring _path) : mime_object (mp) {
     id = nextid++;
 
+    mid  = _mid;
+    path = _path;
+
     isencrypted = encrypted;
     issigned    = _signed;
     crypt       = _cr;
@@ -119,7 +123,7 @@ namespace Astroid {
 
       /* contains a GMimeMessage with a potential substructure */
       GMimeMessage * msg = g_mime_message_part_get_message ((GMimeMessagePart *) mime_object);
-      kids.push_back (refptr<Chunk>(new Chunk((GMimeObject *) msg)));
+      kids.push_back (refptr<Chunk>(new Chunk((GMimeObject *) msg, false, false, refptr<Crypto> (), mid, path + ".0")));
 
     } else if GMIME_IS_MESSAGE_PARTIAL (mime_object) {
       LOG (debug) << "chunk: partial";
@@ -129,7 +133,7 @@ namespace Astroid {
           g_mime_message_partial_get_total ((GMimeMessagePartial *) mime_object)
           );
 
-      kids.push_back (refptr<Chunk>(new Chunk((GMimeObject *) msg)));
+      kids.push_back (refptr<Chunk>(new Chunk((GMimeObject *) msg, false, false, refptr<Crypto> (), mid, path + ".0")));
 
 
     } else if GMIME_IS_MULTIPART (mime_object) {
@@ -137,16 +141,29 @@ namespace Astroid {
 
       int total = g_mime_multipart_get_count ((GMimeMultipart *) mime_object);
 
+      /* decryption and verification results are cached by message id
+       * and part path */
+      Crypto::CachedPart cached = { refptr<Crypto> (), NULL };
+      bool   use_cache = !mid.empty ();
+      ustring cache_key = mid + "/" + path;
+      bool   is_cached = false;
+
       if (GMIME_IS_MULTIPART_ENCRYPTED (mime_object) || GMIME_IS_MULTIPART_SIGNED (mime_object)) {
 
         /* inline PGP is handled in GMIME_IS_PART () above */
 
-        ustring protocol = "";
-        const char * _protocol = g_mime_content_type_get_parameter (content_type, "protocol");
-        if (_protocol != NULL) protocol = _protocol;
-        crypt = refptr<Crypto> (new Crypto (protocol));
-        if (!crypt->ready) {
-          LOG (error) << "chunk: no crypto ready.";
+        if (use_cache && Crypto::cache_lookup (cache_key, cached)) {
+          crypt     = cached.crypt;
+          is_cached = true;
+
+        } else {
+          ustring protocol = "";
+          const char * _protocol = g_mime_content_type_get_parameter (content_type, "protocol");
+          if (_protocol != NULL) protocol = _protocol;
+          crypt = refptr<Crypto> (new Crypto (protocol));
+          if (!crypt->ready) {
+            LOG (error) << "chunk: no crypto ready.";
+          }
         }
       }
 
@@ -159,11 +176,25 @@ namespace Astroid {
             return;
           }
 
-          GMimeObject * k = crypt->decrypt_and_verify (mime_object);
+          GMimeObject * k = NULL;
+
+          if (is_cached) {
+            k = cached.part;
+          } else {
+            k = crypt->decrypt_and_verify (mime_object);
+          }
 
           if (k != NULL) {
-            auto c = refptr<Chunk>(new Chunk(k, true, crypt->verify_tried, crypt));
+            auto c = refptr<Chunk>(new Chunk(k, true, crypt->verify_tried, crypt, mid, path + ".0"));
             kids.push_back (c);
+
+            if (!is_cached) {
+              /* the chunk holds its own reference, the cache takes (or
+               * drops) the one returned by the decryption. failed
+               * decryptions are not cached so that they are tried again. */
+              if (use_cache) Crypto::cache_store (cache_key, { crypt, k });
+              else           g_object_unref (k);
+            }
           } else {
             /* will be displayed as failed decrypted part */
             viewable = true;
@@ -180,9 +211,13 @@ namespace Astroid {
               (GMimeMultipart *) mime_object,
               0);
 
-          crypt->verify_signature (mime_object);
+          if (!is_cached) {
+            bool verified = crypt->verify_signature (mime_object);
+
+            if (use_cache && verified) Crypto::cache_store (cache_key, { crypt, NULL });
+          }
 
-          auto c = refptr<Chunk>(new Chunk(mo, false, true, crypt));
+          auto c = refptr<Chunk>(new Chunk(mo, false, true, crypt, mid, path + ".0"));
           kids.push_back (c);
 
       } else {
@@ -196,7 +231,7 @@ namespace Astroid {
               (GMimeMultipart *) mime_object,
               i);
 
-          auto c = refptr<Chunk>(new Chunk(mo, isencrypted, issigned, crypt));
+          auto c = refptr<Chunk>(new Chunk(mo, isencrypted, issigned, crypt, mid, ustring::compose ("%1.%2", path, i)));
           kids.push_back (c);
         }
 
@@ -484,7 +519,33 @@ namespace Astroid {
     return data;
   }
 
-  bool Chunk::save_to (std::string filename, bool overwrite) {
+  bool Chunk::save_to (std::string filename, bool overwrite, std::function<bool (gint64)> progress) {
+    std::string to = save_path (filename, overwrite);
+    if (to.empty ()) return false;
+
+    GMimeContentEncoding encoding = GMIME_CONTENT_ENCODING_DEFAULT;
+    GMimeStream * stream;
+
+    if (GMIME_IS_PART (mime_object)) {
+      /* decode and write in blocks, without holding the whole part in
+       * memory */
+      GMimeDataWrapper * content = g_mime_part_get_content (GMIME_PART (mime_object));
+      encoding = g_mime_data_wrapper_get_encoding (content);
+      stream = g_mime_data_wrapper_get_stream (content);
+      g_object_ref (stream);
+
+    } else {
+      stream = g_mime_stream_mem_new ();
+      g_mime_object_write_to_stream (mime_object, NULL, stream);
+    }
+
+    bool success = save_stream (stream, encoding, to, overwrite, progress);
+    g_object_unref (stream);
+
+    return success;
+  }
+
+  std::string Chunk::save_path (std::string filename, bool overwrite) {
     /* saves chunk to file name, if filename is dir, own name */
     using bfs::path;
 
@@ -511,9 +572,63 @@ namespace Astroid {
       to /= path (fname.c_str ());
     }
 
+    if (exists (to) && !overwrite) {
+      LOG (error) << "chunk: save: file already exists! not writing: " << to;
+      return "";
+    }
+
+    if (!exists(to.parent_path ()) || !is_directory (to.parent_path())) {
+      LOG (error) << "chunk: save: parent path does not exist or is not a directory.";
+      return "";
+    }
+
+    return to.string ();
+  }
+
+  GMimeStream * Chunk::detached_stream (ustring message_file, GMimeContentEncoding & encoding) {
+    encoding = GMIME_CONTENT_ENCODING_DEFAULT;
+
+    if (GMIME_IS_PART (mime_object)) {
+      GMimeDataWrapper * content = g_mime_part_get_content (GMIME_PART (mime_object));
+      encoding = g_mime_data_wrapper_get_encoding (content);
+      GMimeStream * stream = g_mime_data_wrapper_get_stream (content);
+
+      /* the parser hands out substreams that share the file handle of the
+       * message, with bounds that are offsets in the file. */
+      if (!message_file.empty () && GMIME_IS_STREAM_FILE (stream)) {
+        GError * err = NULL;
+        GMimeStream * file = g_mime_stream_file_open (message_file.c_str (), "r", &err);
+
+        if (file != NULL) {
+          GMimeStream * sub = g_mime_stream_substream (file, stream->bound_start, stream->bound_end);
+          g_object_unref (file);
+          return sub;
+        }
+
+        LOG (warn) << "chunk: could not open message file, copying part: " << (err ? err->message : "");
+        if (err) g_error_free (err);
+      }
+
+      /* in memory, e.g. decrypted */
+      GMimeStream * mem = g_mime_stream_mem_new ();
+      g_mime_stream_reset (stream);
+      g_mime_stream_write_to_stream (stream, mem);
+      g_mime_stream_reset (mem);
+      return mem;
+
+    } else {
+      GMimeStream * mem = g_mime_stream_mem_new ();
+      g_mime_object_write_to_stream (mime_object, NULL, mem);
+      g_mime_stream_reset (mem);
+      return mem;
+    }
+  }
+
+  bool Chunk::save_stream (GMimeStream * stream, GMimeContentEncoding encoding, std::string to, bool overwrite, std::function<bool (gint64)> progress) {
     LOG (info) << "chunk: saving to: " << to;
 
-    if (exists (to)) {
+    if (bfs::exists (to)) {
+      /* two parts may have ended up with the same name */
       if (!overwrite) {
         LOG (error) << "chunk: save: file already exists! not writing.";
         return false;
@@ -522,19 +637,72 @@ namespace Astroid {
       }
     }
 
-    if (!exists(to.parent_path ()) || !is_directory (to.parent_path())) {
-      LOG (error) << "chunk: save: parent path does not exist or is not a directory.";
+    GMimeStream * out = g_mime_stream_fs_open (to.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644, NULL);
+
+    if (out == NULL) {
+      LOG (error) << "chunk: save: could not open file for writing.";
       return false;
     }
 
-    std::ofstream f (to.c_str (), std::ofstream::binary);
+    g_mime_stream_reset (stream);
+
+    GMimeStream * filter_stream = g_mime_stream_filter_new (stream);
 
-    auto data = contents ();
-    f.write (reinterpret_cast<char*>(data->get_data ()), data->size ());
+    switch (encoding) {
+      case GMIME_CONTENT_ENCODING_BASE64:
+      case GMIME_CONTENT_ENCODING_QUOTEDPRINTABLE:
+      case GMIME_CONTENT_ENCODING_UUENCODE:
+        {
+          GMimeFilter * filter = g_mime_filter_basic_new (encoding, false);
+          g_mime_stream_filter_add (GMIME_STREAM_FILTER (filter_stream), filter);
+          g_object_unref (filter);
+        }
+        break;
 
-    f.close ();
+      default:
+        break;
+    }
+
+    bool success = true;
+
+    char buf[SAVE_BLOCK];
+    gint64 written = 0;
+    ssize_t n;
+
+    while ((n = g_mime_stream_read (filter_stream, buf, SAVE_BLOCK)) > 0) {
+      if (g_mime_stream_write (out, buf, n) != n) {
+        LOG (error) << "chunk: save: failed writing to file.";
+        success = false;
+        break;
+      }
+
+      written += n;
+
+      if (progress && !progress (written)) {
+        LOG (warn) << "chunk: save: cancelled.";
+        success = false;
+        break;
+      }
+    }
+
+    if (n < 0) {
+      LOG (error) << "chunk: save: failed reading part.";
+      success = false;
+    }
+
+    g_object_unref (filter_stream);
+
+    if (g_mime_stream_flush (out) < 0) success = false;
+    g_mime_stream_close (out);
+    g_object_unref (out);
+
+    if (!success) {
+      /* do not leave partial files behind */
+      boost::system::error_code ec;
+      bfs::remove (to, ec);
+    }
 
-    return true;
+    return success;
   }
 
   refptr<Chunk> Chunk::get_by_id (int _id, bool check_siblings) {
@@ -4,6 +4,7 @@
 # include <map>
 # include <atomic>
 # include <string>
+# include <functional>
 
 # include <gmime/gmime.h>
 
@@ -19,11 +20,16 @@ namespace Astroid {
       static std::atomic<uint> nextid;
 
     public:
-      Chunk (GMimeObject *, bool encrypted = false, bool _signed = false, refptr<Crypto> _cr = refptr<Crypto> ());
+      Chunk (GMimeObject *, bool encrypted = false, bool _signed = false, refptr<Crypto> _cr = refptr<Crypto> (), ustring mid = "", ustring path = "0");
       ~Chunk ();
 
       int id;
 
+      /* message id of the containing message and position in the mime
+       * tree, used to key the crypto cache */
+      ustring mid;
+      ustring path;
+
       /* Chunk assumes ownership of these */
       GMimeObject *       mime_object = NULL;
       GMimeContentType *  content_type;
@@ -64,7 +70,23 @@ namespace Astroid {
       size_t  get_file_size ();
       refptr<Glib::ByteArray> contents ();
 
-      bool save_to (std::string filename, bool overwrite = false);
+      /* write the decoded part to filename, progress is called with the
+       * number of bytes written after each block and may return false to
+       * cancel. */
+      bool save_to (std::string filename, bool overwrite = false, std::function<bool (gint64)> progress = nullptr);
+      static const size_t SAVE_BLOCK = 64 * 1024;
+
+      /* the file save_to would write to, empty if it cannot be saved */
+      std::string save_path (std::string filename, bool overwrite = false);
+
+      /* the encoded content in a stream that shares no state with the
+       * message, so that it can be read on another thread. parts that are
+       * read from message_file get their own handle on it, others are
+       * copied. */
+      GMimeStream * detached_stream (ustring message_file, GMimeContentEncoding & encoding);
+
+      /* decode the stream and write it to the file to, see save_to */
+      static bool save_stream (GMimeStream * stream, GMimeContentEncoding encoding, std::string to, bool overwrite = false, std::function<bool (gint64)> progress = nullptr);
       void open ();
       void save ();
 
@@ -14,11 +14,18 @@
 # include "modes/help_mode.hh"
 # include "modes/saved_searches.hh"
 # include "utils/utils.hh"
+# include "utils/vector_utils.hh"
 # include "db.hh"
+# include "poll.hh"
+# include "actions/action_manager.hh"
 
 using namespace std;
 
 namespace Astroid {
+  TagTrie CommandBar::tag_trie;
+  bool    CommandBar::tags_loaded = false;
+  bool    CommandBar::tags_stale  = false;
+
   CommandBar::CommandBar () {
     set_show_close_button ();
     connect_entry (entry);
@@ -45,16 +52,15 @@ namespace Astroid {
     entry.signal_changed ().connect (
         sigc::mem_fun (this, &CommandBar::entry_changed));
 
-    /* set up tags */
-    {
-      Db db (Db::DbMode::DATABASE_READ_ONLY);
-      db.load_tags ();
-    }
-
     tag_completion          = refptr<TagCompletion> (new TagCompletion());
     search_completion       = refptr<SearchCompletion> (new SearchCompletion());
     text_search_completion  = refptr<SearchTextCompletion> (new SearchTextCompletion ());
     difftag_completion      = refptr<DiffTagCompletion> (new DiffTagCompletion ());
+
+    astroid->poll->signal_poll_state ().connect (
+        sigc::mem_fun (this, &CommandBar::on_poll_state));
+    astroid->actions->signal_refreshed ().connect (
+        sigc::mem_fun (this, &CommandBar::on_refreshed));
   }
 
   void CommandBar::set_main_window (MainWindow * mw) {
@@ -76,6 +82,8 @@ namespace Astroid {
 
     switch (mode) {
       case CommandMode::Search:
+        use_tags (cmd);
+
         if (callback == NULL && (cmd.size() > 0)) {
           Mode * m = new ThreadIndex (main_window, cmd);
 
@@ -92,9 +100,12 @@ namespace Astroid {
           text_search_completion->add_query (cmd);
         }
       case CommandMode::AttachMids:
+        break;
+
       case CommandMode::DiffTag:
       case CommandMode::Tag:
         {
+          use_tags (cmd);
         }
         break;
     }
@@ -189,9 +200,64 @@ namespace Astroid {
     entry.set_text (cmd);
   }
 
+  void CommandBar::load_db_tags () {
+    /* the tag list is not needed before the bar is used the first time,
+     * after a poll only the new tags are added to the trie */
+    if (tags_loaded && !tags_stale) return;
+
+    Db db (Db::DbMode::DATABASE_READ_ONLY);
+    db.load_tags ();
+
+    tag_trie.update (Db::tags);
+
+    tags_loaded = true;
+    tags_stale  = false;
+  }
+
+  void CommandBar::on_poll_state (bool polling) {
+    if (!polling) tags_stale = true;
+  }
+
+  void CommandBar::on_refreshed () {
+    tags_stale = true;
+  }
+
+  void CommandBar::use_tags (ustring cmd) {
+    if (mode == CommandMode::Search) {
+      ustring_sz pos = 0;
+
+      while ((pos = cmd.find ("tag:", pos)) != ustring::npos) {
+        pos += 4;
+
+        ustring_sz end = cmd.find_first_of (") ", pos);
+        if (end == ustring::npos) end = cmd.size ();
+
+        tag_trie.use (cmd.substr (pos, end - pos));
+        pos = end;
+      }
+
+    } else if (mode == CommandMode::Tag) {
+      /* the listed tags are on the thread now */
+      for (ustring t : VectorUtils::split_and_trim (cmd, "[, ]")) {
+        tag_trie.insert (t);
+        tag_trie.use (t);
+      }
+
+    } else if (mode == CommandMode::DiffTag) {
+      for (ustring t : VectorUtils::split_and_trim (cmd, " ")) {
+        if (t[0] == '-') continue;
+        if (t[0] == '+') t = t.substr (1);
+
+        tag_trie.insert (t);
+        tag_trie.use (t);
+      }
+    }
+  }
+
   void CommandBar::start_searching (ustring searchstring) {
     /* set up completion */
-    search_completion->load_tags (Db::tags);
+    load_db_tags ();
+    search_completion->reset ();
     search_completion->load_history ();
     search_completion->orig_text = "";
     search_completion->history_pos = 0;
@@ -216,7 +282,8 @@ namespace Astroid {
 
   void CommandBar::start_tagging (ustring tagstring) {
     /* set up completion */
-    tag_completion->load_tags (Db::tags);
+    load_db_tags ();
+    tag_completion->reset ();
     entry.set_completion (tag_completion);
     current_completion = tag_completion;
 
@@ -227,7 +294,8 @@ namespace Astroid {
 
   void CommandBar::start_difftagging (ustring tagstring) {
     /* set up completion */
-    difftag_completion->load_tags (Db::tags);
+    load_db_tags ();
+    difftag_completion->reset ();
     entry.set_completion (difftag_completion);
     current_completion = difftag_completion;
 
@@ -406,8 +474,11 @@ namespace Astroid {
 
     } else if (mode == CommandMode::Tag || mode == CommandMode::DiffTag || mode == CommandMode::Search) {
 
-      if (current_completion)
-        refptr<TagCompletion>::cast_dynamic (current_completion)->color_tags (edit_mode);
+      if (current_completion) {
+        refptr<TagCompletion> t = refptr<TagCompletion>::cast_dynamic (current_completion);
+        t->refill ();
+        t->color_tags (edit_mode);
+      }
 
     }
   }
@@ -474,17 +545,39 @@ namespace Astroid {
     set_minimum_key_length (1);
   }
 
-  void CommandBar::TagCompletion::load_tags (vector<ustring> _tags) {
-    tags = _tags;
-    sort (tags.begin(), tags.end());
+  void CommandBar::TagCompletion::reset () {
+    completion_model->clear ();
+    filled = false;
+    filled_key.clear ();
+  }
+
+  void CommandBar::TagCompletion::refill () {
+    ustring key;
+    bool in_tag = get_key (key);
+
+    if (!in_tag) {
+      if (filled) reset ();
+      return;
+    }
+
+    if (filled && key == filled_key) return;
 
     completion_model->clear ();
 
-    /* fill model with tags */
-    for (ustring t : tags) {
+    /* fill model with the best matching tags only */
+    for (ustring t : tag_trie.complete (key, MAX_COMPLETIONS)) {
       auto row = *(completion_model->append ());
       row[m_columns.m_tag] = t;
     }
+
+    filled     = true;
+    filled_key = key;
+  }
+
+  bool CommandBar::TagCompletion::get_key (ustring &key) {
+    ustring_sz pos;
+    key = get_partial_tag (pos);
+    return true;
   }
 
   /* searches backwards to the previous ' ' and extracts the
@@ -531,27 +624,8 @@ namespace Astroid {
       const ustring&, const
       Gtk::TreeModel::const_iterator& iter)
   {
-    if (iter)
-    {
-
-      ustring_sz pos;
-      ustring key = get_partial_tag (pos);
-
-      Gtk::TreeModel::Row row = *iter;
-
-      Glib::ustring::size_type key_length = key.size();
-      Glib::ustring filter_string = row[m_columns.m_tag];
-
-      Glib::ustring filter_string_start = filter_string.substr(0, key_length);
-
-      // the key is lower-case, even if the user input is not.
-      filter_string_start = filter_string_start.lowercase();
-
-      if(key.lowercase () == filter_string_start)
-        return true; // a match was found.
-    }
-
-    return false; // no match.
+    /* the model only holds the completions for the current key */
+    return iter ? true : false;
   }
 
 
@@ -695,8 +769,6 @@ namespace Astroid {
 
   CommandBar::SearchCompletion::SearchCompletion ()
   {
-    set_match_func (sigc::mem_fun (*this,
-          &CommandBar::SearchCompletion::match));
   }
 
   void CommandBar::SearchCompletion::load_history () {
@@ -745,32 +817,9 @@ namespace Astroid {
     return true;
   }
 
-  bool CommandBar::SearchCompletion::match (
-      const ustring&,
-      const Gtk::TreeModel::const_iterator& iter)
-  {
-    ustring key;
+  bool CommandBar::SearchCompletion::get_key (ustring &key) {
     ustring_sz pos;
-    bool in_tag_search = get_partial_tag (key, pos);
-
-    if (in_tag_search && iter)
-    {
-
-      Gtk::TreeModel::Row row = *iter;
-
-      Glib::ustring::size_type key_length = key.size();
-      Glib::ustring filter_string = row[m_columns.m_tag];
-
-      Glib::ustring filter_string_start = filter_string.substr(0, key_length);
-
-      // the key is lower-case, even if the user input is not.
-      filter_string_start = filter_string_start.lowercase();
-
-      if(key.lowercase () == filter_string_start)
-        return true; // a match was found.
-    }
-
-    return false; // no match.
+    return get_partial_tag (key, pos);
   }
 
 
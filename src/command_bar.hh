@@ -15,6 +15,7 @@
 
 # include "astroid.hh"
 # include "proto.hh"
+# include "utils/tag_trie.hh"
 
 namespace Astroid {
   class CommandBar : public Gtk::SearchBar {
@@ -64,6 +65,18 @@ namespace Astroid {
     private:
       void reset_bar ();
 
+      /* load tags from db on first use, the trie is shared by all
+       * completions and updated when the db has been polled */
+      static TagTrie tag_trie;
+      static bool tags_loaded;
+      static bool tags_stale;
+      void load_db_tags ();
+      void on_poll_state (bool);
+      void on_refreshed ();
+
+      /* count the tags in an applied command for ranking completions */
+      void use_tags (ustring);
+
       class GenericCompletion : public Gtk::EntryCompletion {
         public:
           refptr<Gtk::ListStore> completion_model;
@@ -88,8 +101,13 @@ namespace Astroid {
         public:
           TagCompletion ();
 
-          void load_tags (std::vector<ustring>);
-          std::vector<ustring> tags; // must be sorted
+          /* fill the model with the best completions for the current
+           * partial tag, only done when the partial tag changes */
+          void refill ();
+          void reset ();
+          static const unsigned int MAX_COMPLETIONS = 50;
+          bool    filled = false;
+          ustring filled_key;
 
           // tree model columns, for the EntryCompletion's filter model
           class ModelColumns : public Gtk::TreeModel::ColumnRecord
@@ -107,6 +125,9 @@ namespace Astroid {
           ustring break_on = ", ";
           ustring get_partial_tag (ustring_sz&);
 
+          /* the partial tag to complete, false if not completing a tag */
+          virtual bool get_key (ustring&);
+
           bool match (const ustring&, const
               Gtk::TreeModel::const_iterator&) override;
 
@@ -153,9 +174,7 @@ namespace Astroid {
           std::vector <ustring> history;
 
           bool get_partial_tag (ustring&, ustring_sz&);
-
-          bool match (const ustring&, const
-              Gtk::TreeModel::const_iterator&) override;
+          bool get_key (ustring&) override;
 
           bool on_match_selected(const Gtk::TreeModel::iterator& iter) override;
 
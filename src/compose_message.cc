@@ -25,6 +25,7 @@
 # include "actions/onmessage.hh"
 # include "utils/address.hh"
 # include "utils/ustring_utils.hh"
+# include "utils/filter_process.hh"
 # ifndef DISABLE_PLUGINS
   # include "plugin/manager.hh"
 # endif
@@ -174,65 +175,41 @@ namespace Astroid {
 
       GMimeStream * contentStream = g_mime_stream_mem_new();
 
-      /* pipe through markdown to html generator */
-      int pid;
-      int stdin;
-      int stdout;
-      int stderr;
-      markdown_success = true;
-      vector<string> args = Glib::shell_parse_argv (astroid->config().get<string>("editor.markdown_processor"));
-      try {
-        Glib::spawn_async_with_pipes ("",
-                          args,
-                          Glib::SPAWN_DO_NOT_REAP_CHILD |
-                          Glib::SPAWN_SEARCH_PATH,
-                          sigc::slot <void> (),
-                          &pid,
-                          &stdin,
-                          &stdout,
-                          &stderr
-                          );
-
-        refptr<Glib::IOChannel> ch_stdin;
-        refptr<Glib::IOChannel> ch_stdout;
-        refptr<Glib::IOChannel> ch_stderr;
-        ch_stdin  = Glib::IOChannel::create_from_fd (stdin);
-        ch_stdout = Glib::IOChannel::create_from_fd (stdout);
-        ch_stderr = Glib::IOChannel::create_from_fd (stderr);
+      /* pipe through markdown to html generator, unless the same source
+       * has been rendered before */
+      std::string _html;
+      markdown_pending = false;
 
-        ch_stdin->write (md_body_content);
-        ch_stdin->close ();
-
-        ustring _html;
-        ch_stdout->read_to_end (_html);
-        ch_stdout->close ();
+      if (markdown_lookup (md_body_content, _html)) {
+        LOG (debug) << "cm: md: using cached html.";
+        markdown_success = true;
 
+      } else {
+        FilterProcess::Result r = astroid->markdown_processor->convert (md_body_content);
 
-        ustring _err;
-        ch_stderr->read_to_end (_err);
-        ch_stderr->close ();
+        if (markdown_async) {
+          /* leave out the html part until the processor is done, the
+           * caller collects the result with markdown_collect */
+          markdown_pending        = true;
+          markdown_pending_source = md_body_content;
+          markdown_pending_result = r;
+          markdown_success        = false;
 
-        if (!_err.empty ()) {
-          LOG (error) << "cm: md: " << _err;
-          markdown_error   = _err;
-          markdown_success = false;
         } else {
-
-          LOG (debug) << "cm: md: got html: " << _html;
-
-          if (0 > g_mime_stream_write(contentStream, _html.c_str(), _html.bytes())) {
-            LOG (error) << "cm: md: could not write html string to GMimeStream contentStream";
-            markdown_error   = "Could not write html string to GMimeStream contentStream";
-            markdown_success = false;
-          }
+          ustring h;
+          markdown_success = markdown_collect (md_body_content, r, h, markdown_error);
+          _html = h;
         }
+      }
 
-        g_spawn_close_pid (pid);
-      } catch (Glib::SpawnError &ex) {
-        LOG (error) << "cm: md: failed to spawn markdown processor: " << ex.what ();
+      if (markdown_success) {
+        LOG (debug) << "cm: md: got html: " << _html;
 
-        markdown_success = false;
-        markdown_error   = "Failed to spawn markdown processor: " + ex.what();
+        if (0 > g_mime_stream_write(contentStream, _html.c_str(), _html.size ())) {
+          LOG (error) << "cm: md: could not write html string to GMimeStream contentStream";
+          markdown_error   = "Could not write html string to GMimeStream contentStream";
+          markdown_success = false;
+        }
       }
 
       if (markdown_success) {
@@ -258,6 +235,57 @@ namespace Astroid {
     g_object_unref(messagePart);
   }
 
+  /* markdown cache {{{ */
+  std::mutex ComposeMessage::markdown_cache_m;
+  std::unordered_map<std::size_t, ComposeMessage::CachedMarkdown> ComposeMessage::markdown_cache;
+  std::deque<std::size_t> ComposeMessage::markdown_cache_order;
+
+  bool ComposeMessage::markdown_lookup (const std::string & source, std::string & html) {
+    std::lock_guard<std::mutex> lk (markdown_cache_m);
+
+    auto f = markdown_cache.find (std::hash<std::string> () (source));
+    if (f == markdown_cache.end () || f->second.source != source) return false;
+
+    html = f->second.html;
+    return true;
+  }
+
+  bool ComposeMessage::markdown_collect (
+      const std::string & source,
+      FilterProcess::Result r,
+      ustring & html,
+      ustring & error)
+  {
+    bool success = astroid->markdown_processor->wait (r, html, error);
+
+    if (!error.empty ()) {
+      /* anything on stderr is considered a failure */
+      LOG (error) << "cm: md: " << error;
+      return false;
+
+    } else if (!success) {
+      error = "Failed to run markdown processor.";
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lk (markdown_cache_m);
+    std::size_t k = std::hash<std::string> () (source);
+
+    if (markdown_cache.find (k) == markdown_cache.end ()) {
+      markdown_cache_order.push_back (k);
+
+      while (markdown_cache_order.size () > MAX_MARKDOWN_CACHED) {
+        markdown_cache.erase (markdown_cache_order.front ());
+        markdown_cache_order.pop_front ();
+      }
+    }
+
+    markdown_cache[k] = { source, html };
+
+    return true;
+  }
+  /* }}} */
+
   void ComposeMessage::load_message (ustring _mid, ustring fname) {
     set_id (_mid);
     UnprocessedMessage msg (_mid, fname);
@@ -9,11 +9,14 @@
 # include <thread>
 # include <mutex>
 # include <condition_variable>
+# include <unordered_map>
+# include <deque>
 
 # include <gmime/gmime.h>
 
 # include "astroid.hh"
 # include "proto.hh"
+# include "utils/filter_process.hh"
 
 namespace bfs = boost::filesystem;
 
@@ -49,6 +52,18 @@ namespace Astroid {
       bool markdown_success = false;
       ustring markdown_error = "";
 
+      /* do not wait for the markdown processor in build (), if the source
+       * has not been rendered before the message is built without the html
+       * part and markdown_pending is set. */
+      bool markdown_async   = false;
+      bool markdown_pending = false;
+      std::string           markdown_pending_source;
+      FilterProcess::Result markdown_pending_result;
+
+      /* rendered markdown is cached by source */
+      static bool markdown_lookup (const std::string & source, std::string & html);
+      static bool markdown_collect (const std::string & source, FilterProcess::Result, ustring & html, ustring & error);
+
       struct Attachment {
         public:
           Attachment ();
@@ -88,6 +103,16 @@ namespace Astroid {
       ustring encryption_error = "";
 
     private:
+      struct CachedMarkdown {
+        std::string source;
+        std::string html;
+      };
+
+      static std::mutex markdown_cache_m;
+      static std::unordered_map<std::size_t, CachedMarkdown> markdown_cache;
+      static std::deque<std::size_t> markdown_cache_order;
+      static const size_t MAX_MARKDOWN_CACHED = 20;
+
       ustring message_file;
       bfs::path save_to;
       bool      dryrun;
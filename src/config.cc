@@ -170,11 +170,16 @@ namespace Astroid {
 
     default_config.put ("astroid.debug.dryrun_sending", false);
 
+    /* memoize results of plugin hooks that only depend on their arguments
+     * (tag formatting, tag colors and avatars) */
+    default_config.put ("astroid.plugins.cache_pure_hooks", false);
+
     /* only show hints with a level higher than this */
     default_config.put ("astroid.hints.level", 0);
 
     default_config.put ("astroid.log.syslog", false);
     default_config.put ("astroid.log.stdout", true);
+    default_config.put ("astroid.log.view_lines", 10000); // records kept in the log view
 
 # if DEBUG
     default_config.put ("astroid.log.level", "debug"); // (trace, debug, info, warning, error, fatal)
@@ -194,6 +199,9 @@ namespace Astroid {
     default_config.put ("thread_index.page_jump_rows", 6);
     default_config.put ("thread_index.sort_order", "newest");
 
+    /* number of threads after the cursor to load in advance */
+    default_config.put ("thread_index.prefetch_threads", 2);
+
     default_config.put ("general.time.clock_format", "local"); // or 24h, 12h
     default_config.put ("general.time.same_year", "%b %-e");
     default_config.put ("general.time.diff_year", "%x");
@@ -238,9 +246,13 @@ namespace Astroid {
     default_config.put ("editor.attachment_directory", "~");
 
     default_config.put ("editor.markdown_processor", "cmark");
+    default_config.put ("editor.markdown_processor_persistent", ""); // long running, framed: <length>\n<data>
+    default_config.put ("editor.markdown_processor_timeout", 10000); // ms
     default_config.put ("editor.markdown_on", false); // default
 
     default_config.put ("mail.reply.quote_processor", "w3m -dump -T text/html"); // e.g. lynx -dump
+    default_config.put ("mail.reply.quote_processor_persistent", ""); // long running, framed: <length>\n<data>
+    default_config.put ("mail.reply.quote_processor_timeout", 5000); // ms, per html part
 
     /* mail composition */
     default_config.put ("mail.reply.quote_line", "Excerpts from %1's message of %2:"); // %1 = author, %2 = pretty_verbose_date
@@ -258,6 +270,8 @@ namespace Astroid {
     /* polling */
     default_config.put ("poll.interval", Poll::DEFAULT_POLL_INTERVAL); // seconds
     default_config.put ("poll.always_full_refresh", false); // always do full refresh after poll, slow.
+    default_config.put ("poll.watch_db", true); // refresh threads changed by other programs
+    default_config.put ("poll.watch_delay", 500); // ms to collect database changes before refreshing
 
     /* attachments
      *
@@ -292,10 +306,19 @@ namespace Astroid {
     /* expand flagged messages by default */
     default_config.put ("thread_view.expand_flagged", true);
 
+    /* number of thread views kept ready in the background */
+    default_config.put ("thread_view.preload_views", 1);
+
+    /* threads with more messages than this are only rendered around the
+     * focused message, the rest is loaded on demand. 0 renders all. */
+    default_config.put ("thread_view.window_threshold", 200);
+    default_config.put ("thread_view.window_size", 20);
+
     /* crypto */
     default_config.put ("crypto.gpg.path", "gpg2");
     default_config.put ("crypto.gpg.always_trust", true);
     default_config.put ("crypto.gpg.enabled", true);
+    default_config.put ("crypto.gpg.cache_decrypted", true); // in memory only
 
     /* saved searches */
     default_config.put ("saved_searches.show_on_startup", false);
@@ -317,6 +340,7 @@ namespace Astroid {
       LOG (info) << "cf: test config, loading defaults.";
       config = setup_default_config (true);
       config.put ("poll.interval", 0);
+      config.put ("poll.watch_db", false);
       config.put ("accounts.charlie.gpgkey", "gaute@astroidmail.bar");
       config.put ("mail.send_delay", 0);
       std::string test_nmcfg_path;
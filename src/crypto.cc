@@ -13,6 +13,13 @@
 # include "chunk.hh"
 
 namespace Astroid {
+  std::mutex Crypto::pool_m;
+  std::vector<GMimeCryptoContext *> Crypto::pool;
+
+  std::mutex Crypto::cache_m;
+  std::map<ustring, Crypto::CachedPart> Crypto::cache;
+  std::deque<ustring> Crypto::cache_order;
+
   Crypto::Crypto (ustring _protocol) {
 
     id = Chunk::nextid++;
@@ -54,7 +61,83 @@ namespace Astroid {
     /* if (slist)        g_object_unref (slist); */
     /* if (rlist)        g_object_unref (rlist); */
     if (decrypt_res)  g_object_unref (decrypt_res);
-    if (gpgctx)       g_object_unref (gpgctx);
+    release_context ();
+  }
+
+  void Crypto::release_context () {
+    if (!gpgctx) return;
+
+    std::lock_guard<std::mutex> lk (pool_m);
+
+    if (pool.size () < MAX_POOLED) {
+      pool.push_back (gpgctx);
+    } else {
+      g_object_unref (gpgctx);
+    }
+
+    gpgctx = NULL;
+  }
+
+  bool Crypto::cache_lookup (ustring key, CachedPart & out) {
+    std::lock_guard<std::mutex> lk (cache_m);
+
+    auto c = cache.find (key);
+    if (c == cache.end ()) return false;
+
+    LOG (debug) << "crypto: using cached part: " << key;
+    out = c->second;
+    return true;
+  }
+
+  void Crypto::cache_store (ustring key, CachedPart p) {
+    if (!astroid->config ("crypto").get<bool> ("gpg.cache_decrypted")) {
+      if (p.part) g_object_unref (p.part);
+      return;
+    }
+
+    /* only the results are needed from now on, the chunks have been
+     * built */
+    if (p.crypt) p.crypt->release_context ();
+
+    std::lock_guard<std::mutex> lk (cache_m);
+
+    auto c = cache.find (key);
+    if (c != cache.end ()) {
+      if (c->second.part) g_object_unref (c->second.part);
+      c->second = p;
+      return;
+    }
+
+    if (cache.size () >= MAX_CACHED_PARTS) {
+      auto e = cache.find (cache_order.front ());
+      if (e->second.part) g_object_unref (e->second.part);
+      cache.erase (e);
+      cache_order.pop_front ();
+    }
+
+    cache[key] = p;
+    cache_order.push_back (key);
+  }
+
+  void Crypto::cache_clear () {
+    {
+      std::lock_guard<std::mutex> lk (cache_m);
+
+      LOG (debug) << "crypto: clearing " << cache.size () << " cached parts.";
+
+      for (auto &c : cache) {
+        if (c.second.part) g_object_unref (c.second.part);
+      }
+
+      cache.clear ();
+      cache_order.clear ();
+    }
+
+    /* the cached Crypto objects have returned their contexts by now */
+    std::lock_guard<std::mutex> lk (pool_m);
+
+    for (auto ctx : pool) g_object_unref (ctx);
+    pool.clear ();
   }
 
   GMimeObject * Crypto::decrypt_and_verify (GMimeObject * part) {
@@ -286,6 +369,16 @@ namespace Astroid {
 
   bool Crypto::create_gpg_context () {
 
+    {
+      std::lock_guard<std::mutex> lk (pool_m);
+
+      if (!pool.empty ()) {
+        gpgctx = pool.back ();
+        pool.pop_back ();
+        return true;
+      }
+    }
+
     if (!astroid->in_test ()) {
 
 # if (GMIME_MAJOR_VERSION < 3)
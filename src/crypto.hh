@@ -2,6 +2,10 @@
 
 # include <gmime/gmime.h>
 # include <boost/property_tree/ptree.hpp>
+# include <mutex>
+# include <map>
+# include <deque>
+# include <vector>
 
 # include "astroid.hh"
 # include "utils/address.hh"
@@ -55,10 +59,18 @@ namespace Astroid {
       GMimeSignatureList *   slist       = NULL;
       GMimeCertificateList * rlist       = NULL;
 
+      /* return the gpg context to the pool, the results above are kept */
+      void release_context ();
+
     private:
       bool create_gpg_context ();
       GMimeCryptoContext * gpgctx = NULL;
 
+      /* contexts of destroyed Crypto objects are reused */
+      static std::mutex pool_m;
+      static std::vector<GMimeCryptoContext *> pool;
+      static const size_t MAX_POOLED = 4;
+
       ustring protocol;
       ustring gpgpath;
       bool    always_trust = false;
@@ -66,6 +78,27 @@ namespace Astroid {
 
       bool verify_signature_list (GMimeSignatureList *);
 
+    public:
+      /* decrypted parts and verification results by message id and part
+       * path, kept in memory only. only successful decryptions and
+       * verifications are stored, the part is NULL for signed parts. the
+       * cache takes the reference to the part, and the gpg context of the
+       * Crypto is returned to the pool. cache_clear also frees the pool. */
+      struct CachedPart {
+        refptr<Crypto> crypt;
+        GMimeObject *  part;
+      };
+
+      static bool cache_lookup (ustring key, CachedPart &);
+      static void cache_store (ustring key, CachedPart);
+      static void cache_clear ();
+
+    private:
+      static std::mutex cache_m;
+      static std::map<ustring, CachedPart> cache;
+      static std::deque<ustring> cache_order;
+      static const size_t MAX_CACHED_PARTS = 100;
+
     public:
       static ustring  get_md5_digest (ustring str);
       static gssize   get_md5_length ();
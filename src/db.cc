@@ -1,6 +1,7 @@
 # include <iostream>
 # include <vector>
 # include <algorithm>
+# include <cstring>
 # include <exception>
 # include <boost/filesystem.hpp>
 
@@ -20,6 +21,7 @@
 # include "utils/address.hh"
 # include "actions/action_manager.hh"
 # include "message_thread.hh"
+# include "poll.hh"
 
 using namespace std;
 using namespace boost::filesystem;
@@ -102,6 +104,7 @@ namespace Astroid {
       open_db_read_only (true);
     } else if (mode == DATABASE_READ_WRITE) {
       open_db_write (true);
+      open_revision = get_revision ();
     } else {
       throw invalid_argument ("db: mode must be read-only or read-write");
     }
@@ -234,13 +237,21 @@ namespace Astroid {
     if (!closed) {
       closed = true;
 
+      unsigned long close_revision = 0;
+
       if (nm_db != NULL) {
+        if (mode == DATABASE_READ_WRITE) close_revision = get_revision ();
+
         LOG (info) << "db: closing db.";
         notmuch_database_destroy (nm_db);
         nm_db = NULL;
       }
 
       if (mode == DATABASE_READ_WRITE) {
+        /* our own changes do not need to be refreshed by the watcher */
+        if (close_revision && astroid->poll)
+          astroid->poll->db_written (open_revision, close_revision);
+
         LOG (debug) << "db: rw: releasing lock.";
         release_rw_lock (rw_lock);
       } else {
@@ -555,7 +566,7 @@ namespace Astroid {
    * notmuch thread
    * --------------
    */
-  NotmuchThread::NotmuchThread (notmuch_thread_t * t) {
+  NotmuchThread::NotmuchThread (notmuch_thread_t * t, bool skeleton) {
     const char * ti = notmuch_thread_get_thread_id (t);
     if (ti == NULL) {
       LOG (error) << "nmt: got NULL thread id.";
@@ -564,7 +575,7 @@ namespace Astroid {
 
     thread_id = ti;
 
-    load (t);
+    load (t, skeleton);
   }
 
   NotmuchThread::~NotmuchThread () {
@@ -590,7 +601,7 @@ namespace Astroid {
     return in_notmuch;
   }
 
-  void NotmuchThread::load (notmuch_thread_t * nm_thread) {
+  void NotmuchThread::load (notmuch_thread_t * nm_thread, bool skeleton) {
     unread     = false;
     attachment = false;
     flagged    = false;
@@ -606,7 +617,20 @@ namespace Astroid {
     oldest_date = notmuch_thread_get_oldest_date (nm_thread);
     total_messages = check_total_messages (nm_thread);
     tags        = get_tags (nm_thread);
-    authors     = get_authors (nm_thread);
+
+    if (skeleton) {
+      enriched  = false;
+    } else {
+      authors   = get_authors (nm_thread, unread); // unread from tags
+      enriched  = true;
+      index_str = "";
+    }
+  }
+
+  void NotmuchThread::set_authors (vector<tuple<ustring,bool>> a) {
+    authors   = a;
+    enriched  = true;
+    index_str = "";
   }
 
   vector<ustring> NotmuchThread::get_tags (notmuch_thread_t * nm_thread) {
@@ -623,11 +647,11 @@ namespace Astroid {
       tag = notmuch_tags_get (tags); // tag belongs to tags
 
       if (tag != NULL) {
-        if (string(tag) == "unread") {
+        if (strcmp (tag, "unread") == 0) {
           unread = true;
-        } else if (string(tag) == "attachment") {
+        } else if (strcmp (tag, "attachment") == 0) {
           attachment = true;
-        } else if (string(tag) == "flagged") {
+        } else if (strcmp (tag, "flagged") == 0) {
           flagged = true;
         }
 
@@ -643,11 +667,31 @@ namespace Astroid {
     return ttags;
   }
 
-  vector<tuple<ustring,bool>> NotmuchThread::get_authors (notmuch_thread_t * nm_thread) {
+  std::mutex NotmuchThread::author_names_m;
+  std::unordered_map<std::string, ustring> NotmuchThread::author_names;
+
+  ustring NotmuchThread::author_name (const char * from) {
+    /* parsing and decoding the address is the expensive part of loading a
+     * thread, the same authors show up in most threads. */
+    std::lock_guard<std::mutex> lk (author_names_m);
+
+    auto f = author_names.find (from);
+    if (f != author_names.end ()) return f->second;
+
+    if (author_names.size () >= MAX_AUTHOR_NAMES) author_names.clear ();
+
+    ustring a = Address(ustring (from)).fail_safe_name ();
+    author_names[from] = a;
+
+    return a;
+  }
+
+  vector<tuple<ustring,bool>> NotmuchThread::get_authors (notmuch_thread_t * nm_thread, bool any_unread) {
     /* important: this might be called from another thread, we cannot output anything here */
 
     /* returns a vector of authors and whether they are authors of
-     * an unread message in the thread */
+     * an unread message in the thread. if no message in the thread is
+     * unread (from the thread tags) the message tags are not checked. */
     vector<tuple<ustring, bool>> aths;
 
     /* get messages from thread */
@@ -662,32 +706,35 @@ namespace Astroid {
 
       message = notmuch_messages_get (qmessages);
 
-      ustring a;
       const char * ac = notmuch_message_get_header (message, "From");
-      if (ac != NULL) {
-        a = Address(ustring (ac)).fail_safe_name ();
-      } else {
+      if (ac == NULL) {
         /* LOG (error) << "nmt: got NULL for author!"; */
         notmuch_message_destroy (message);
         continue;
       }
 
+      ustring a = author_name (ac);
+
       _unread = false;
 
       /* get tags */
-      notmuch_tags_t *tags;
-      const char *tag;
+      if (any_unread) {
+        notmuch_tags_t *tags;
+        const char *tag;
 
-      for (tags = notmuch_message_get_tags (message);
-           notmuch_tags_valid (tags);
-           notmuch_tags_move_to_next (tags))
-      {
-          tag = notmuch_tags_get (tags);
-          if (ustring (tag) == "unread")
-          {
-            _unread = true;
-            break;
-          }
+        for (tags = notmuch_message_get_tags (message);
+             notmuch_tags_valid (tags);
+             notmuch_tags_move_to_next (tags))
+        {
+            tag = notmuch_tags_get (tags);
+            if (tag != NULL && strcmp (tag, "unread") == 0)
+            {
+              _unread = true;
+              break;
+            }
+        }
+
+        notmuch_tags_destroy (tags);
       }
 
       auto fnd = find_if (aths.begin (), aths.end (),
@@ -6,6 +6,7 @@
 # include <functional>
 
 # include <vector>
+# include <unordered_map>
 
 # include <time.h>
 
@@ -86,7 +87,7 @@ namespace Astroid {
   /* the notmuch thread object should get by on the db only */
   class NotmuchThread : public NotmuchItem {
     public:
-      NotmuchThread (notmuch_thread_t *);
+      NotmuchThread (notmuch_thread_t *, bool skeleton = false);
       ~NotmuchThread ();
 
       time_t  newest_date;
@@ -94,9 +95,16 @@ namespace Astroid {
       int     total_messages;
       std::vector<std::tuple<ustring,bool>> authors;
 
-      void load (notmuch_thread_t *);
+      /* a skeleton thread is loaded without authors, which requires going
+       * through all messages. they are filled in later with set_authors. */
+      bool    enriched = true;
+
+      void load (notmuch_thread_t *, bool skeleton = false);
       bool refresh (Db *) override;
 
+      static std::vector<std::tuple<ustring,bool>> get_authors (notmuch_thread_t *, bool any_unread);
+      void set_authors (std::vector<std::tuple<ustring,bool>>);
+
       bool remove_tag (Db *, ustring) override;
       bool add_tag (Db *, ustring) override;
       void emit_updated (Db *) override;
@@ -109,10 +117,15 @@ namespace Astroid {
 
     private:
       int check_total_messages (notmuch_thread_t *);
-      std::vector<std::tuple<ustring,bool>> get_authors (notmuch_thread_t *);
       std::vector<ustring> get_tags (notmuch_thread_t *);
 
       ustring index_str = "";
+
+      /* display names by raw From header, shared by all threads */
+      static std::mutex author_names_m;
+      static std::unordered_map<std::string, ustring> author_names;
+      static const size_t MAX_AUTHOR_NAMES = 20000;
+      static ustring author_name (const char *);
   };
 
   class Db {
@@ -196,6 +209,9 @@ namespace Astroid {
       bool open_db_read_only (bool);
       bool closed = false;
 
+      /* revision when a read-write db was opened */
+      unsigned long open_revision = 0;
+
       const int db_open_timeout = 120; // seconds
       const int db_open_delay   = 100;   // milliseconds
 
@@ -11,7 +11,7 @@
 # include "message_thread.hh"
 # include "chunk.hh"
 # include "utils/utils.hh"
-# include "utils/cmd.hh"
+# include "utils/filter_process.hh"
 # include "utils/date_utils.hh"
 # include "utils/address.hh"
 # include "utils/ustring_utils.hh"
@@ -317,7 +317,7 @@ namespace Astroid {
       time = 0;
     }
 
-    root = refptr<Chunk>(new Chunk (g_mime_message_get_mime_part (message)));
+    root = refptr<Chunk>(new Chunk (g_mime_message_get_mime_part (message), false, false, refptr<Crypto> (), mid));
   }
 
   ustring Message::plain_text (bool fallback_html) {
@@ -374,7 +374,10 @@ namespace Astroid {
       return "";
     }
 
-    ustring body;
+    /* html parts are queued with the quote processor as they are found
+     * and collected in order afterwards */
+    vector<pair<ustring, FilterProcess::Result>> parts;
+    ustring text;
 
     function< void (refptr<Chunk>) > app_body =
       [&] (refptr<Chunk> c)
@@ -403,18 +406,13 @@ namespace Astroid {
         if (c->viewable && (c->is_content_type ("text", "plain") || c->is_content_type ("text", "html"))) {
           /* will output html if HTML part */
           if (c->is_content_type ("text", "html")) {
-            ustring quote_cmd = astroid->config ().get<string>("mail.reply.quote_processor");
-
-            if (!quote_cmd.empty()) {
-                ustring h = c->viewable_text (false);
-                ustring _stdout, _stderr;
-                Cmd::pipe (quote_cmd, h, _stdout, _stderr);
-
-                body += _stdout;
+            if (astroid->quote_processor) {
+              parts.push_back (make_pair (text, astroid->quote_processor->convert (c->viewable_text (false))));
+              text.clear ();
             }
 
           } else {
-            body += c->viewable_text (false);
+            text += c->viewable_text (false);
           }
         }
 
@@ -426,6 +424,21 @@ namespace Astroid {
 
     app_body (root);
 
+    ustring body;
+
+    for (auto &p : parts) {
+      body += p.first;
+
+      ustring h;
+      if (astroid->quote_processor->wait (p.second, h)) {
+        body += h;
+      } else {
+        LOG (error) << "message: could not convert html part for quoting.";
+      }
+    }
+
+    body += text;
+
     return body;
   }
 
@@ -847,15 +860,11 @@ namespace Astroid {
 
     if (has_file)
     {
-      std::ifstream src (fname, ios::binary);
-      std::ofstream dst (tofname, ios::binary);
-
-      if (!src.good () || !dst.good ()) {
+      /* the file on disk is the message, no need to go through userspace */
+      if (!Utils::copy_file (path (fname.c_str ()), to)) {
         LOG (error) << "msg: failed writing to: " << tofname;
         return;
       }
-
-      dst << src.rdbuf ();
     } else {
       /* write GMimeMessage */
 
@@ -878,6 +887,21 @@ namespace Astroid {
   refptr<Glib::ByteArray> Message::raw_contents () {
     time_t t0 = clock ();
 
+    if (has_file) {
+      /* read the file directly rather than serializing the message, the
+       * buffer is handed to the byte array without copying */
+      gchar * buf;
+      gsize   len;
+
+      if (g_file_get_contents (fname.c_str (), &buf, &len, NULL)) {
+        auto data = Glib::wrap (g_byte_array_new_take ((guint8 *) buf, len));
+
+        LOG (info) << "message: contents: read " << len << " bytes from file in " << ( (clock () - t0) * 1000.0 / CLOCKS_PER_SEC ) << " ms.";
+
+        return data;
+      }
+    }
+
     // https://github.com/skx/lumail/blob/master/util/attachments.c
 
     GMimeStream * mem = g_mime_stream_mem_new ();
@@ -1093,17 +1117,25 @@ namespace Astroid {
   }
 
   void MessageThread::load_messages (Db * db) {
+    for (auto &mm : begin_load (db)) {
+      load_message (mm.first, mm.second);
+    }
+  }
+
+  std::vector<std::pair<int, refptr<NotmuchMessage>>> MessageThread::begin_load (Db * db) {
     /* update values */
     subject = thread->subject;
     set_first_subject (thread->subject);
 
-    for (auto &mm : thread->messages (db)) {
-      auto m = refptr<Message>(new Message (mm.second, mm.first));
-      if (!first_subject_set) set_first_subject(m->subject);
+    return thread->messages (db);
+  }
 
-      m->subject_is_different = subject_is_different (m->subject);
-      messages.push_back (m);
-    }
+  void MessageThread::load_message (int level, refptr<NotmuchMessage> mm) {
+    auto m = refptr<Message>(new Message (mm, level));
+    if (!first_subject_set) set_first_subject(m->subject);
+
+    m->subject_is_different = subject_is_different (m->subject);
+    messages.push_back (m);
   }
 
   void MessageThread::add_message (ustring fname) {
@@ -155,6 +155,12 @@ namespace Astroid {
       std::vector<refptr<Message>> messages_by_time ();
 
       void load_messages (Db *);
+
+      /* load_messages in steps: begin_load returns the messages that are
+       * then loaded one by one with load_message */
+      std::vector<std::pair<int, refptr<NotmuchMessage>>> begin_load (Db *);
+      void load_message (int level, refptr<NotmuchMessage>);
+
       void add_message (ustring);
       void add_message (refptr<Chunk>);
       void add_message (refptr<Message>);
@@ -604,6 +604,8 @@ namespace Astroid {
   EditMessage::~EditMessage () {
     LOG (debug) << "em: deconstruct.";
 
+    markdown_done.disconnect ();
+
     if (status_icon_visible) {
       main_window->notebook.remove_widget (&message_sending_status_icon);
     }
@@ -855,6 +857,7 @@ namespace Astroid {
 
     /* make message */
     auto c = setup_message ();
+    c->markdown_async = true;
 
     /* set account selector to from address email */
     set_from (c->account);
@@ -862,7 +865,19 @@ namespace Astroid {
     /* build message */
     finalize_message (c);
 
-    if (c->markdown && !c->markdown_success) {
+    markdown_done.disconnect ();
+
+    if (c->markdown_pending) {
+      /* show the text part for now, the preview is reloaded when the
+       * markdown processor is done */
+      set_info ("Rendering markdown..");
+
+      markdown_pending_source = c->markdown_pending_source;
+      markdown_pending_result = c->markdown_pending_result;
+      markdown_done = astroid->markdown_processor->signal_done ().connect (
+          sigc::mem_fun (this, &EditMessage::on_markdown_done));
+
+    } else if (c->markdown && !c->markdown_success) {
       set_warning ("Failed processing markdown: " + UstringUtils::replace (c->markdown_error, "\n", "<br />"));
     }
 
@@ -893,6 +908,26 @@ namespace Astroid {
     in_read = false;
   }
 
+  void EditMessage::on_markdown_done () {
+    if (markdown_pending_result.wait_for (std::chrono::seconds (0)) != std::future_status::ready) {
+      return; // another conversion finished
+    }
+
+    markdown_done.disconnect ();
+
+    ustring html, error;
+    bool success = ComposeMessage::markdown_collect (markdown_pending_source, markdown_pending_result, html, error);
+    markdown_pending_source.clear ();
+
+    if (!success) {
+      set_warning ("Failed processing markdown: " + UstringUtils::replace (error, "\n", "<br />"));
+
+    } else if (!editor_active && !in_read) {
+      /* the html is now cached */
+      read_edited_message ();
+    }
+  }
+
   /* }}} */
 
   void EditMessage::set_info (ustring msg) {
@@ -143,6 +143,12 @@ namespace Astroid {
                                    // it has been edited.
       std::mutex message_draft_m;  // locks message draft
       std::atomic<bool> in_read;   // true if we are already in read
+
+      /* markdown being rendered for the preview */
+      std::string           markdown_pending_source;
+      FilterProcess::Result markdown_pending_result;
+      sigc::connection      markdown_done;
+      void on_markdown_done ();
       void on_tv_ready ();
       void set_warning (ustring);
       void set_info (ustring);
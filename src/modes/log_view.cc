@@ -1,8 +1,9 @@
 # include "astroid.hh"
 
 # include <deque>
-# include <mutex>
+# include <atomic>
 # include <iostream>
+# include <iomanip>
 
 # include <boost/log/trivial.hpp>
 # include <boost/log/sinks/basic_sink_backend.hpp>
@@ -12,6 +13,12 @@
 # include <boost/log/support/date_time.hpp>
 
 # include "log_view.hh"
+# include "utils/startup_profile.hh"
+# include "modes/thread_view/webextension/ae_protocol.hh"
+
+# ifndef DISABLE_PLUGINS
+  # include "plugin/manager.hh"
+# endif
 
 namespace logging = boost::log;
 namespace sinks   = boost::log::sinks;
@@ -19,9 +26,15 @@ namespace expr    = boost::log::expressions;
 
 
 namespace Astroid {
-  LogView::LogView (MainWindow * mw) : Mode (mw) {
+  LogView::LogView (MainWindow * mw) : Mode (mw), ring (RING_SIZE) {
     set_label ("Log");
 
+    notified  = false;
+    max_lines = astroid->config ("astroid.log").get<size_t> ("view_lines");
+
+    time_locale = std::locale (std::locale::classic (),
+        new boost::posix_time::time_facet ("%H:%M:%S.%f"));
+
     scroll.add (tv);
     pack_start (scroll);
 
@@ -33,9 +46,17 @@ namespace Astroid {
     int cols_count = tv.append_column ("log entry", *renderer_text);
     Gtk::TreeViewColumn * pcolumn = tv.get_column (cols_count -1);
     if (pcolumn) {
-      pcolumn->add_attribute (renderer_text->property_markup(), m_columns.m_col_str);
+      /* rows are formatted when drawn, fixed sizing makes sure only
+       * the visible rows are measured */
+      pcolumn->set_cell_data_func (*renderer_text,
+          sigc::mem_fun (this, &LogView::on_cell_data));
+      pcolumn->set_sizing (Gtk::TREE_VIEW_COLUMN_FIXED);
+      pcolumn->set_fixed_width (LINE_WIDTH);
     }
 
+    tv.set_fixed_height_mode (true);
+    tv.signal_map ().connect (sigc::mem_fun (this, &LogView::on_view_map));
+
     tv.set_headers_visible (false);
     tv.set_sensitive (true);
     set_sensitive (true);
@@ -128,6 +149,41 @@ namespace Astroid {
           return true;
         });
 
+# ifndef DISABLE_PLUGINS
+    keys.register_key ("p",
+        "log.plugin_stats",
+        "Show plugin hook statistics",
+        [&] (Key) {
+          astroid->plugin_manager->log_hook_stats ();
+          return true;
+        });
+# endif
+
+    keys.register_key ("s",
+        "log.startup_profile",
+        "Show time spent in each startup phase",
+        [&] (Key) {
+          StartupProfile::log ();
+          return true;
+        });
+
+    keys.register_key ("i",
+        "log.ipc_stats",
+        "Show statistics for messages sent to the thread view",
+        [&] (Key) {
+          AeProtocol::log_stats ();
+          return true;
+        });
+
+    keys.register_key ("I",
+        "log.ipc_stats_reset",
+        "Reset statistics for messages sent to the thread view",
+        [&] (Key) {
+          AeProtocol::reset_stats ();
+          LOG (info) << "ae: ipc statistics reset.";
+          return true;
+        });
+
     keys.loghandle = false;
   }
 
@@ -148,73 +204,159 @@ namespace Astroid {
   }
 
   void LogView::consume () {
-    std::unique_lock<std::mutex> lk (msgs_m);
+    /* clear before draining so that records pushed while we are working
+     * cause a new notification */
+    notified = false;
+
+    LogRing::Record r;
+    while (ring.pop (r)) {
+      append (std::move (r));
+    }
 
-    while (!msgs.empty ()) {
+    unsigned long dropped = ring.dropped;
+    if (dropped > dropped_shown) {
+      LogRing::Record d;
+      d.level   = logging::trivial::warning;
+      d.time    = boost::posix_time::microsec_clock::local_time ();
+      d.message = ustring::compose ("log view: dropped %1 records.", dropped - dropped_shown);
 
-      auto p = msgs.front ();
-      msgs.pop_front ();
+      dropped_shown = dropped;
 
-      lk.unlock ();
+      append (std::move (d));
+    }
 
-      auto iter = store->append();
-      auto row  = *iter;
+    if (tv.get_mapped ()) sync_rows ();
+  }
 
-      row[m_columns.m_col_str] = p;
+  void LogView::append (LogRing::Record && r) {
+    history.push_back (std::move (r));
+    pending_rows++;
 
-      auto path = store->get_path (iter);
-      tv.scroll_to_row (path);
-      tv.set_cursor (path);
+    if (history.size () > max_lines) {
+      history.pop_front ();
+      first_seq++;
 
-      lk.lock (); // for while
+      if (pending_rows >= history.size () + 1) {
+        pending_rows--;
+      } else {
+        store->erase (store->children ().begin ());
+      }
     }
-
-    lk.unlock (); // for while
   }
 
-  LogViewSink::LogViewSink (LogView * lv) {
-    log_view = lv;
+  void LogView::on_view_map () {
+    sync_rows ();
   }
 
-  LogViewSink::LogViewSink (const std::shared_ptr<LogViewSink> &lvs) {
-    log_view = lvs->log_view;
+  void LogView::sync_rows () {
+    if (pending_rows == 0) return;
+
+    unsigned long seq = first_seq + (history.size () - pending_rows);
+
+    Gtk::TreeIter iter;
+    for (; pending_rows > 0; pending_rows--) {
+      iter = store->append ();
+      (*iter)[m_columns.m_col_seq] = seq++;
+    }
+
+    /* only scroll once for the whole batch */
+    auto path = store->get_path (iter);
+    tv.scroll_to_row (path);
+    tv.set_cursor (path);
   }
 
-  void LogViewSink::consume (logging::record_view const& rec, string_type const& message) {
+  void LogView::on_cell_data (Gtk::CellRenderer * r, const Gtk::TreeModel::iterator & iter) {
+    unsigned long seq = (*iter)[m_columns.m_col_seq];
 
-    auto lvl = rec[logging::trivial::severity];
+    Gtk::CellRendererText * rt = static_cast<Gtk::CellRendererText *> (r);
 
-    auto ts  = logging::extract<boost::posix_time::ptime> ("TimeStamp",rec);
-    boost::posix_time::time_facet * f = new boost::posix_time::time_facet ("%H:%M:%S.%f");
+    if (seq < first_seq || (seq - first_seq) >= history.size ()) {
+      rt->property_markup () = "";
+    } else {
+      rt->property_markup () = format_record (history[seq - first_seq]);
+    }
+  }
 
+  ustring LogView::format_record (const LogRing::Record & r) {
     std::ostringstream s;
-    s.imbue (std::locale (s.getloc (), f));
+    s.imbue (time_locale);
 
-    s << "<i>[" << std::setw (6) << lvl << "]</i> ";
-    s << *ts << ": " << Glib::Markup::escape_text (message);
+    s << "<i>[" << std::setw (6) << r.level << "]</i> ";
+    s << r.time << ": " << Glib::Markup::escape_text (r.message);
 
     ustring l = s.str ();
 
-    if (lvl == logging::trivial::error) {
+    if (r.level == logging::trivial::error) {
       l = "<span color=\"red\">" + l + "</span>";
-    } else if (lvl == logging::trivial::warning) {
+    } else if (r.level == logging::trivial::warning) {
       l = "<span color=\"pink\">" + l + "</span>";
-    //} else if (lvl == logging::trivial::info) {
+    //} else if (r.level == logging::trivial::info) {
     //  l = l;
     } else {
       l = "<span color=\"gray\">" + l + "</span>";
     }
 
-    std::unique_lock <std::mutex> lk (log_view->msgs_m);
-    bool notify = log_view->msgs.empty ();
+    return l;
+  }
+
+  LogViewSink::LogViewSink (LogView * lv) {
+    log_view = lv;
+  }
+
+  LogViewSink::LogViewSink (const std::shared_ptr<LogViewSink> &lvs) {
+    log_view = lvs->log_view;
+  }
+
+  void LogViewSink::consume (logging::record_view const& rec, string_type const& message) {
+    /* this may be called from any thread, only copy the record: it is
+     * formatted on the GUI thread if and when it is shown. */
+    LogRing::Record r;
+
+    auto lvl = rec[logging::trivial::severity];
+    r.level  = lvl ? lvl.get () : logging::trivial::info;
+
+    auto ts  = logging::extract<boost::posix_time::ptime> ("TimeStamp",rec);
+    if (ts) r.time = ts.get ();
+
+    r.message = message;
+
+    log_view->ring.push (std::move (r));
+
+    if (!log_view->notified.exchange (true)) log_view->msgs_d.emit ();
+  }
+
+  /* LogRing */
+  LogRing::LogRing (size_t capacity) : buf (capacity) {
+    dropped = 0;
+    head    = 0;
+    tail    = 0;
+  }
 
-    log_view->msgs.push_back (l);
+  bool LogRing::push (Record && r) {
+    size_t t = tail.load (std::memory_order_relaxed);
+    size_t h = head.load (std::memory_order_acquire);
 
-    lk.unlock ();
+    if (t - h >= buf.size ()) {
+      dropped++;
+      return false;
+    }
 
-    if (notify) log_view->msgs_d.emit ();
+    buf[t % buf.size ()] = std::move (r);
+    tail.store (t + 1, std::memory_order_release);
 
+    return true;
   }
 
+  bool LogRing::pop (Record & r) {
+    size_t h = head.load (std::memory_order_relaxed);
+    size_t t = tail.load (std::memory_order_acquire);
+
+    if (h == t) return false;
+
+    r = std::move (buf[h % buf.size ()]);
+    head.store (h + 1, std::memory_order_release);
+
+    return true;
+  }
 }
 
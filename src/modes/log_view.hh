@@ -1,7 +1,9 @@
 # pragma once
 
 # include <deque>
-# include <mutex>
+# include <vector>
+# include <atomic>
+# include <string>
 
 # include "proto.hh"
 # include "astroid.hh"
@@ -9,12 +11,40 @@
 # include <boost/log/sinks/basic_sink_backend.hpp>
 # include <boost/log/sinks/sync_frontend.hpp>
 # include <boost/log/sinks/frontend_requirements.hpp>
+# include <boost/date_time/posix_time/posix_time_types.hpp>
 namespace logging = boost::log;
 namespace sinks   = boost::log::sinks;
 
 # include "mode.hh"
 
 namespace Astroid {
+  /* Fixed capacity ring buffer of unformatted log records.
+   *
+   * There is exactly one producer (the sink, calls are serialized by the
+   * synchronous frontend) and one consumer (the GUI thread), so no locks
+   * are needed. Records that do not fit are dropped and counted.
+   */
+  class LogRing {
+    public:
+      struct Record {
+        logging::trivial::severity_level level;
+        boost::posix_time::ptime          time;
+        std::string                       message;
+      };
+
+      LogRing (size_t capacity);
+
+      bool push (Record && r);  /* producer */
+      bool pop  (Record & r);   /* consumer */
+
+      std::atomic<unsigned long> dropped;
+
+    private:
+      std::vector<Record> buf;
+      std::atomic<size_t> head; /* next to read  */
+      std::atomic<size_t> tail; /* next to write */
+  };
+
   class LogViewSink : public sinks::basic_formatted_sink_backend <
                   char,
                   sinks::synchronized_feeding>
@@ -50,9 +80,9 @@ namespace Astroid {
         public:
 
           ModelColumns()
-          { add(m_col_str);}
+          { add(m_col_seq);}
 
-          Gtk::TreeModelColumn<Glib::ustring> m_col_str;
+          Gtk::TreeModelColumn<unsigned long> m_col_seq;
       };
 
       ModelColumns m_columns;
@@ -61,13 +91,32 @@ namespace Astroid {
       Gtk::ScrolledWindow scroll;
       refptr<Gtk::ListStore> store;
 
-      /* consume log on GUI thread */
-      std::deque<ustring> msgs;
+      /* records are passed from the sink through the ring and kept
+       * unformatted in the history, rows only refer to their sequence
+       * number and are formatted when they are drawn. */
+      static const size_t RING_SIZE  = 4096;
+      static const int    LINE_WIDTH = 3000; // px
+      LogRing ring;
+
+      std::deque<LogRing::Record> history;
+      unsigned long first_seq = 0;
+      size_t        max_lines;
+      unsigned long dropped_shown = 0;
 
-      std::mutex msgs_m;
+      /* records in the history that do not have a row yet */
+      size_t        pending_rows = 0;
+
+      std::atomic<bool> notified;
       Glib::Dispatcher msgs_d;
 
       void consume ();
+      void append (LogRing::Record &&);
+      void sync_rows ();
+      void on_view_map ();
+
+      std::locale time_locale;
+      ustring format_record (const LogRing::Record &);
+      void on_cell_data (Gtk::CellRenderer *, const Gtk::TreeModel::iterator &);
   };
 
 }
@@ -1,11 +1,14 @@
 # include <iostream>
 # include <fstream>
+# include <algorithm>
+# include <cstring>
 # include <boost/filesystem.hpp>
 
 # include "astroid.hh"
 # include "raw_message.hh"
 # include "message_thread.hh"
 # include "utils/ustring_utils.hh"
+# include "utils/utils.hh"
 
 using namespace std;
 namespace bfs = boost::filesystem;
@@ -27,6 +30,9 @@ namespace Astroid {
 
     show_all_children ();
 
+    tv.get_vadjustment ()->signal_value_changed ().connect (
+        sigc::mem_fun (this, &RawMessage::on_scroll));
+
     keys.title = "Raw message"; // {{{
     keys.register_key ("j", { Key (GDK_KEY_Down) },
         "raw.down",
@@ -79,10 +85,20 @@ namespace Astroid {
         "Scroll to end",
         [&] (Key) {
           /* select end */
+          load_all ();
           auto adj = tv.get_vadjustment ();
           adj->set_value (adj->get_upper());
           return true;
         });
+
+    keys.register_key ("e",
+        "raw.toggle_base64",
+        "Show or hide long base64 encoded parts",
+        [&] (Key) {
+          elide_base64 = !elide_base64;
+          reload ();
+          return true;
+        });
     // }}}
   }
 
@@ -100,23 +116,21 @@ namespace Astroid {
     /* load message source */
     LOG (info) << "rm: loading message from file: " << fname;
 
-    refptr<Gtk::TextBuffer> buf = tv.get_buffer ();
-    stringstream s;
-
-    /* add filenames */
-    s << "Filename: " << fname << endl << endl;
+    header = ustring::compose ("Filename: %1\n\n", fname);
 
-    std::string data = Glib::file_get_contents (fname);
+    GError * err = NULL;
+    mapped = g_mapped_file_new (fname, FALSE, &err);
 
-    auto cnv = UstringUtils::data_to_ustring (data.size (), data.c_str ());
-
-    if (cnv.first) {
-      s << cnv.second;
+    if (mapped) {
+      data = g_mapped_file_get_contents (mapped);
+      size = g_mapped_file_get_length (mapped);
     } else {
-      s << "Error: Could not convert input to UTF-8.";
+      LOG (error) << "rm: could not open file: " << fname << ": " << err->message;
+      header += ustring::compose ("Error: Could not open file: %1", err->message);
+      g_error_free (err);
     }
 
-    buf->set_text ( s.str () );
+    reload ();
   }
 
   RawMessage::RawMessage (MainWindow *mw, refptr<Message> _msg) : RawMessage (mw) {
@@ -127,30 +141,37 @@ namespace Astroid {
     /* load message source */
     LOG (info) << "rm: loading message.. ";
 
-    refptr<Gtk::TextBuffer> buf = tv.get_buffer ();
-
-    stringstream s;
-
     /* add filenames */
     if (msg->has_file) {
-      s << "Filename: " << msg->fname << endl << endl;
-    } else {
-      s << "Filename: (none, memory)"<< endl << endl;
-    }
+      header = ustring::compose ("Filename: %1\n\n", msg->fname);
 
-    auto c = msg->raw_contents ();
-    auto cnv = UstringUtils::bytearray_to_ustring (c);
+      GError * err = NULL;
+      mapped = g_mapped_file_new (msg->fname.c_str (), FALSE, &err);
+
+      if (mapped) {
+        data = g_mapped_file_get_contents (mapped);
+        size = g_mapped_file_get_length (mapped);
+      } else {
+        LOG (warn) << "rm: could not map file, using message contents: " << err->message;
+        g_error_free (err);
+      }
 
-    if (cnv.first) {
-      s << cnv.second;
     } else {
-      s << "Error: Could not convert input to UTF-8.";
+      header = "Filename: (none, memory)\n\n";
     }
 
-    buf->set_text ( s.str () );
+    if (!mapped) {
+      bytes = msg->raw_contents ();
+      data  = (const char *) bytes->get_data ();
+      size  = bytes->size ();
+    }
+
+    reload ();
   }
 
   RawMessage::~RawMessage () {
+    if (mapped) g_mapped_file_unref (mapped);
+
     if (delete_on_close) {
       if (bfs::exists (fname)) {
         unlink (fname.c_str ());
@@ -159,6 +180,101 @@ namespace Astroid {
   }
 
 
+  void RawMessage::reload () {
+    loaded = 0;
+    tv.get_buffer ()->set_text (header);
+
+    /* fill the view, the rest is loaded when scrolling */
+    load_page ();
+    load_page ();
+  }
+
+  void RawMessage::load_page () {
+    if (loaded >= size) return;
+
+    gsize   end = std::min (size, loaded + PAGE_SIZE);
+    std::string page;
+
+    while (loaded < size && loaded < end) {
+      const char * line = data + loaded;
+      const char * nl   = (const char *) memchr (line, '\n', size - loaded);
+      gsize len = nl ? (nl - line + 1) : (size - loaded);
+
+      if (elide_base64 && is_base64_line (line, len)) {
+        /* count the run of base64 lines */
+        gsize run = 0;
+        int   lines = 0;
+
+        while (loaded + run < size) {
+          const char * l = data + loaded + run;
+          const char * n = (const char *) memchr (l, '\n', size - loaded - run);
+          gsize ll = n ? (n - l + 1) : (size - loaded - run);
+
+          if (!is_base64_line (l, ll)) break;
+
+          run += ll;
+          lines++;
+        }
+
+        if (lines >= ELIDE_LINES) {
+          page += ustring::compose ("[ %1 lines (%2) of base64 hidden, press 'e' to show ]\n",
+              lines, Utils::format_size (run)).raw ();
+
+          loaded += run;
+          continue;
+        }
+
+        /* short run, show it */
+        page.append (line, run);
+        loaded += run;
+        continue;
+      }
+
+      page.append (line, len);
+      loaded += len;
+    }
+
+    auto cnv = UstringUtils::data_to_ustring (page.size (), page.c_str ());
+
+    refptr<Gtk::TextBuffer> buf = tv.get_buffer ();
+
+    if (cnv.first) {
+      buf->insert (buf->end (), cnv.second);
+    } else {
+      buf->insert (buf->end (), "Error: Could not convert input to UTF-8.\n");
+    }
+
+    LOG (debug) << "rm: loaded " << loaded << " of " << size << " bytes.";
+  }
+
+  void RawMessage::load_all () {
+    while (loaded < size) load_page ();
+  }
+
+  void RawMessage::on_scroll () {
+    if (loaded >= size) return;
+
+    /* load next page when getting close to the end of what is loaded */
+    auto adj = tv.get_vadjustment ();
+    if ((adj->get_value () + 2 * adj->get_page_size ()) >= adj->get_upper ()) {
+      load_page ();
+    }
+  }
+
+  bool RawMessage::is_base64_line (const char * line, gsize len) {
+    while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r')) len--;
+
+    /* encoders wrap at 76 (or 64) characters */
+    if (len < 40 || len > 100) return false;
+
+    for (gsize i = 0; i < len; i++) {
+      char c = line[i];
+      if (!(isalnum ((unsigned char) c) || c == '+' || c == '/' || c == '=')) return false;
+    }
+
+    return true;
+  }
+
   void RawMessage::grab_modal () {
     add_modal_grab ();
     grab_focus ();
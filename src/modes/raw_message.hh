@@ -24,6 +24,29 @@ namespace Astroid {
 
       Gtk::ScrolledWindow scroll;
       Gtk::TextView       tv;
+
+      /* the source is memory mapped (or kept as a byte array for messages
+       * without a file) and converted and inserted into the buffer a page
+       * at the time as the view is scrolled down. */
+      GMappedFile *           mapped = NULL;
+      refptr<Glib::ByteArray> bytes;
+
+      const char *  data = NULL;
+      gsize         size = 0;
+      gsize         loaded = 0;
+      ustring       header;
+
+      static const gsize PAGE_SIZE = 256 * 1024;
+
+      /* long base64 bodies are shown as one line unless expanded */
+      bool elide_base64 = true;
+      static const int ELIDE_LINES = 20;
+      static bool is_base64_line (const char * line, gsize len);
+
+      void reload ();
+      void load_page ();
+      void load_all ();
+      void on_scroll ();
   };
 }
 
@@ -11,28 +11,64 @@
 # include <queue>
 # include <mutex>
 # include <functional>
+# include <algorithm>
 
 # include <notmuch.h>
 
 namespace Astroid {
   int QueryLoader::nextid = 0;
+  const std::vector<ustring> QueryLoader::sort_strings = { "oldest", "newest", "messageid", "unsorted" };
+  std::map<QueryLoader::Key, std::weak_ptr<QueryLoader>> QueryLoader::loaders;
+
+  std::shared_ptr<QueryLoader> QueryLoader::get (ustring query, notmuch_sort_t sort) {
+    /* drop loaders no longer in use */
+    for (auto it = loaders.begin (); it != loaders.end (); ) {
+      if (it->second.expired ()) it = loaders.erase (it);
+      else it++;
+    }
 
-  QueryLoader::QueryLoader () {
-    id = nextid++;
+    ustring excluded;
+    for (ustring & t : Db::excluded_tags) excluded += t + ";";
+
+    Key k = std::make_tuple (std::string (query), static_cast<int> (sort), std::string (excluded));
+
+    auto f = loaders.find (k);
+    if (f != loaders.end ()) {
+      std::shared_ptr<QueryLoader> q = f->second.lock ();
+      LOG (debug) << "ql (" << q->id << "): sharing loaded query: " << query;
+      return q;
+    }
+
+    std::shared_ptr<QueryLoader> q (new QueryLoader (query, sort));
+    loaders[k] = q;
+    q->start ();
+
+    return q;
+  }
 
+  notmuch_sort_t QueryLoader::default_sort () {
     ustring sort_order = astroid->config ().get<std::string> ("thread_index.sort_order");
     if (sort_order == "newest") {
-      sort = NOTMUCH_SORT_NEWEST_FIRST;
+      return NOTMUCH_SORT_NEWEST_FIRST;
     } else if (sort_order == "oldest") {
-      sort = NOTMUCH_SORT_OLDEST_FIRST;
+      return NOTMUCH_SORT_OLDEST_FIRST;
     } else if (sort_order == "messageid") {
-      sort = NOTMUCH_SORT_MESSAGE_ID;
+      return NOTMUCH_SORT_MESSAGE_ID;
     } else if (sort_order == "unsorted") {
-      sort = NOTMUCH_SORT_UNSORTED;
+      return NOTMUCH_SORT_UNSORTED;
     } else {
       LOG (error) << "ti: unknown sort order, must be 'newest', 'oldest', 'messageid' or 'unsorted': " << sort_order << ", using 'newest'.";
-      sort = NOTMUCH_SORT_NEWEST_FIRST;
+      return NOTMUCH_SORT_NEWEST_FIRST;
     }
+  }
+
+  QueryLoader::QueryLoader (ustring _query, notmuch_sort_t _sort) :
+    query (_query),
+    sort (_sort)
+  {
+    id = nextid++;
+
+    list_store = Glib::RefPtr<ThreadIndexListStore>(new ThreadIndexListStore ());
 
     loaded_threads = 0;
     total_messages = 0;
@@ -42,6 +78,9 @@ namespace Astroid {
     queue_has_data.connect (
         sigc::mem_fun (this, &QueryLoader::to_list_adder));
 
+    enriched_ready.connect (
+        sigc::mem_fun (this, &QueryLoader::enricher));
+
     deferred_threads_d.connect (
         sigc::mem_fun (this, &QueryLoader::update_deferred_changed_threads));
 
@@ -57,12 +96,12 @@ namespace Astroid {
     stop (true);
     list_store->clear ();
     std::queue<refptr<NotmuchThread>> ().swap (to_list_store);
+    std::queue<Enriched> ().swap (to_enrich);
     std::queue<ustring> ().swap (changed_threads);
   }
 
-  void QueryLoader::start (ustring q) {
+  void QueryLoader::start () {
     std::lock_guard<std::mutex> lk (loader_m);
-    query = q;
     run = true;
     loader_thread = std::thread (&QueryLoader::loader, this);
   }
@@ -80,14 +119,20 @@ namespace Astroid {
     std::lock_guard<std::mutex> lk (to_list_m);
     list_store->clear ();
 
+    for (auto lv : list_views) lv->marked.clear ();
+
     std::queue<refptr<NotmuchThread>> ().swap (to_list_store);
+    std::queue<Enriched> ().swap (to_enrich);
 
-    start (query);
+    start ();
   }
 
-  void QueryLoader::refine_query (ustring q) {
-    query = q;
-    reload ();
+  void QueryLoader::attach (ThreadIndexListView * lv) {
+    list_views.push_back (lv);
+  }
+
+  void QueryLoader::detach (ThreadIndexListView * lv) {
+    list_views.erase (std::remove (list_views.begin (), list_views.end (), lv), list_views.end ());
   }
 
   void QueryLoader::refresh_stats_db (Db * db) {
@@ -145,6 +190,8 @@ namespace Astroid {
     loaded_threads = 0; // incremented in list_adder
     int i = 0;
 
+    std::deque<Pending> pending;
+
     for (;
          run && notmuch_threads_valid (threads);
          notmuch_threads_move_to_next (threads)) {
@@ -157,24 +204,41 @@ namespace Astroid {
         throw database_error ("ql: could not get thread (is NULL)");
       }
 
-      NotmuchThread *t = new NotmuchThread (thread);
-
-      notmuch_thread_destroy (thread);
+      refptr<NotmuchThread> t (new NotmuchThread (thread, true));
 
       std::unique_lock<std::mutex> lk (to_list_m);
 
-      to_list_store.push (refptr<NotmuchThread>(t));
+      to_list_store.push (t);
 
       lk.unlock ();
 
+      pending.push_back ({ t, thread, t->unread });
+
       i++;
 
       if ((i % 100) == 0) {
         if (run && !in_destructor)
           queue_has_data.emit ();
       }
+
+      while (run && pending.size () >= MAX_PENDING) {
+        enrich_next (pending);
+      }
     }
 
+    if (run && !in_destructor)
+      queue_has_data.emit ();
+
+    while (run && !pending.empty ()) {
+      enrich_next (pending);
+    }
+
+    if (!in_destructor)
+      enriched_ready.emit ();
+
+    /* any threads left if stopped are freed with the query */
+    pending.clear ();
+
     /* closing query */
     notmuch_threads_destroy (threads);
     notmuch_query_destroy (nmquery);
@@ -194,6 +258,77 @@ namespace Astroid {
     db.close ();
   }
 
+  void QueryLoader::enrich_next (std::deque<Pending> & pending) {
+    /* take visible threads first, otherwise in the order they were loaded */
+    auto next = pending.begin ();
+    bool prioritized = false;
+
+    {
+      std::lock_guard<std::mutex> lk (priority_m);
+
+      while (!priority.empty () && !prioritized) {
+        refptr<NotmuchThread> p = priority.front ();
+        priority.pop_front ();
+
+        auto f = std::find_if (pending.begin (), pending.end (),
+            [&] (Pending & pe) { return pe.thread == p; });
+
+        if (f != pending.end ()) {
+          next = f;
+          prioritized = true;
+        }
+      }
+    }
+
+    Pending pe = *next;
+    pending.erase (next);
+
+    auto authors = NotmuchThread::get_authors (pe.nm_thread, pe.unread);
+    notmuch_thread_destroy (pe.nm_thread);
+
+    std::unique_lock<std::mutex> lk (to_list_m);
+    to_enrich.push ({ pe.thread, authors });
+    size_t n = to_enrich.size ();
+    lk.unlock ();
+
+    if ((prioritized || n >= 100) && !in_destructor) enriched_ready.emit ();
+  }
+
+  void QueryLoader::enricher () {
+    std::lock_guard<std::mutex> lk (to_list_m);
+
+    while (!to_enrich.empty ()) {
+      Enriched e = to_enrich.front ();
+      to_enrich.pop ();
+
+      /* the thread may have been refreshed since it was loaded */
+      if (!e.thread->enriched) e.thread->set_authors (e.authors);
+    }
+
+    for (auto lv : list_views) lv->queue_draw ();
+  }
+
+  void QueryLoader::prioritize_visible () {
+    if (!loading ()) return;
+
+    std::lock_guard<std::mutex> lk (priority_m);
+    priority.clear ();
+
+    for (auto list_view : list_views) {
+      Gtk::TreePath start, end;
+      if (!list_view->get_visible_range (start, end)) continue;
+
+      for (auto it = list_view->filtered_store->get_iter (start); it; it++) {
+        Gtk::ListStore::Row row = *it;
+        refptr<NotmuchThread> t = row[list_store->columns.thread];
+
+        if (t && !t->enriched) priority.push_back (t);
+
+        if (list_view->filtered_store->get_path (it) == end) break;
+      }
+    }
+  }
+
   void QueryLoader::to_list_adder () {
     std::lock_guard<std::mutex> lk (to_list_m);
 
@@ -218,9 +353,14 @@ namespace Astroid {
 
       if ((loaded_threads % 100) == 0) {
         LOG (debug) << "ql: loaded " << loaded_threads << " threads.";
-        if (!in_destructor && !list_view->filter_txt.empty()) stats_ready.emit ();
+        if (!in_destructor &&
+            std::any_of (list_views.begin (), list_views.end (),
+              [] (ThreadIndexListView * lv) { return !lv->filter_txt.empty (); }))
+          stats_ready.emit ();
       }
     }
+
+    prioritize_visible ();
   }
 
   void QueryLoader::update_deferred_changed_threads () {
@@ -320,6 +460,8 @@ namespace Astroid {
         LOG (debug) << "ql: deleted";
         path = list_store->get_path (fwditer);
         list_store->erase (fwditer);
+
+        for (auto lv : list_views) lv->marked.erase (thread_id);
       }
 
       changed = true;
@@ -330,11 +472,15 @@ namespace Astroid {
       if (in_query) {
         LOG (debug) << "ql: new thread for query, adding..";
 
-        /* get current cursor path, if we are at first row and the new addition
+        /* get current cursor paths, if we are at first row and the new addition
          * is before we should scroll up. */
-        Gtk::TreePath path;
-        Gtk::TreeViewColumn *c;
-        list_view->get_cursor (path, c);
+        std::vector<Gtk::TreePath> paths;
+        for (auto list_view : list_views) {
+          Gtk::TreePath path;
+          Gtk::TreeViewColumn *c;
+          list_view->get_cursor (path, c);
+          paths.push_back (path);
+        }
 
         auto iter = list_store->prepend ();
         Gtk::ListStore::Row newrow = *iter;
@@ -358,10 +504,12 @@ namespace Astroid {
             first_thread_ready.emit ();
         } else {
 
-          if (path == Gtk::TreePath ("0")) {
-            Gtk::TreePath addpath = list_store->get_path (iter);
-            if (addpath <= path) {
-              list_view->set_cursor (addpath);
+          for (unsigned int k = 0; k < list_views.size (); k++) {
+            if (paths[k] == Gtk::TreePath ("0")) {
+              Gtk::TreePath addpath = list_views[k]->filtered_store->convert_child_path_to_path (list_store->get_path (iter));
+              if (addpath && addpath <= paths[k]) {
+                list_views[k]->set_cursor (addpath);
+              }
             }
           }
         }
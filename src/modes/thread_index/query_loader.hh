@@ -3,43 +3,63 @@
 # include <thread>
 # include <mutex>
 # include <queue>
+# include <deque>
+# include <map>
+# include <memory>
+# include <tuple>
 # include <notmuch.h>
 
 # include "proto.hh"
 # include "thread_index_list_view.hh"
 
 namespace Astroid {
+  /* loads the threads of a query into a list store and keeps it up to date.
+   * loaders are shared between all thread indexes showing the same query with
+   * the same sort order, each index has its own view and filter on top of
+   * the shared list store. */
   class QueryLoader : public sigc::trackable {
     public:
       static int nextid;
 
       int id;
-      QueryLoader ();
+      QueryLoader (ustring query, notmuch_sort_t sort);
       ~QueryLoader ();
 
-      void refine_query (ustring);
+      /* get the loader for query, a new one is started if no other index
+       * is showing the query. */
+      static std::shared_ptr<QueryLoader> get (ustring query, notmuch_sort_t sort);
+      static notmuch_sort_t default_sort ();
 
-      void start (ustring);
       void stop (bool in_destructor = false);
       void reload ();
 
+      void attach (ThreadIndexListView *);
+      void detach (ThreadIndexListView *);
+
       unsigned int loaded_threads;
       unsigned int total_messages;
       unsigned int unread_messages;
 
       refptr<ThreadIndexListStore> list_store;
-      ThreadIndexListView * list_view;
+      std::vector<ThreadIndexListView *> list_views;
 
-      notmuch_sort_t sort;
-      std::vector<ustring> sort_strings = { "oldest", "newest", "messageid", "unsorted" };
+      const ustring query;
+      const notmuch_sort_t sort;
+      static const std::vector<ustring> sort_strings;
 
       Glib::Dispatcher first_thread_ready;
       Glib::Dispatcher stats_ready;
 
       bool loading ();
 
+      /* enrich the threads in the visible rows first */
+      void prioritize_visible ();
+
     private:
-      ustring query;
+      typedef std::tuple<std::string, int, std::string> Key;
+      static std::map<Key, std::weak_ptr<QueryLoader>> loaders;
+
+      void start ();
       void refresh_stats_db (Db *);
 
       std::atomic<bool> run;
@@ -55,6 +75,30 @@ namespace Astroid {
       void to_list_adder ();
       Glib::Dispatcher queue_has_data;
 
+      /* threads are first added as skeletons, without authors, and then
+       * enriched on the loader thread. at most MAX_PENDING threads are
+       * kept open for enrichment while loading. */
+      struct Pending {
+        refptr<NotmuchThread> thread;
+        notmuch_thread_t *    nm_thread;
+        bool                  unread;
+      };
+
+      struct Enriched {
+        refptr<NotmuchThread> thread;
+        std::vector<std::tuple<ustring,bool>> authors;
+      };
+
+      static const unsigned int MAX_PENDING = 1000;
+      void enrich_next (std::deque<Pending> &);
+
+      std::queue<Enriched> to_enrich;
+      Glib::Dispatcher enriched_ready;
+      void enricher ();
+
+      std::deque<refptr<NotmuchThread>> priority;
+      std::mutex priority_m;
+
       /* this is a list of threads that got a changed signal
        * while loading */
       Glib::Dispatcher deferred_threads_d;
@@ -14,8 +14,10 @@
 # include "thread_index_list_view.hh"
 # include "thread_index_list_cell_renderer.hh"
 # include "modes/thread_view/thread_view.hh"
+# include "modes/thread_view/thread_view_pool.hh"
 # include "modes/saved_searches.hh"
 # include "main_window.hh"
+# include "utils/startup_profile.hh"
 # ifndef DISABLE_PLUGINS
   # include "plugin/manager.hh"
 # endif
@@ -28,29 +30,23 @@ namespace Astroid {
     name = _name;
     set_orientation (Gtk::Orientation::ORIENTATION_VERTICAL);
 
-    /* set up treeview */
-    list_store = Glib::RefPtr<ThreadIndexListStore>(new ThreadIndexListStore ());
-    queryloader.list_store = list_store;
+    /* load threads, or share them with another index showing the same query */
+    queryloader = QueryLoader::get (query_string, QueryLoader::default_sort ());
 
+    /* set up treeview */
+    list_store = queryloader->list_store;
     list_view  = Gtk::manage(new ThreadIndexListView (this, list_store));
-    queryloader.list_view = list_view;
-
     scroll     = Gtk::manage(new ThreadIndexScrolled (main_window, list_store, list_view));
 
-    list_view->set_sort_type (queryloader.sort);
+    /* fill in the rows scrolled to first while loading */
+    scroll->scroll.get_vadjustment ()->signal_value_changed ().connect (
+        [this] () { queryloader->prioritize_visible (); });
 
     add_pane (0, scroll);
 
     show_all ();
 
-    /* load threads */
-    queryloader.stats_ready.connect (
-        sigc::mem_fun (this, &ThreadIndex::on_stats_ready));
-
-    queryloader.first_thread_ready.connect (
-        sigc::mem_fun (this, &ThreadIndex::on_first_thread_ready));
-
-    queryloader.start (query_string);
+    attach_loader ();
 
 # ifndef DISABLE_PLUGINS
     plugins = new PluginManager::ThreadIndexExtension (this);
@@ -76,7 +72,7 @@ namespace Astroid {
 
     keys.register_key (Key((guint) GDK_KEY_dollar), "thread_index.refresh", "Refresh query",
         [&] (Key) {
-          queryloader.reload ();
+          queryloader->reload ();
           return true;
         });
 
@@ -88,8 +84,8 @@ namespace Astroid {
                 [&](ustring new_query) {
 
                   query_string = new_query;
+                  load_query (query_string, queryloader->sort);
                   set_label (get_label ());
-                  queryloader.refine_query (query_string);
 
                   /* add to saved searches */
                   SavedSearches::add_query_to_history (query_string);
@@ -117,18 +113,19 @@ namespace Astroid {
     keys.register_key ("C-s", "thread_index.cycle_sort",
         "Cycle through sort options: 'oldest', 'newest', 'messageid', 'unsorted'",
         [&] (Key) {
-          if (queryloader.sort == NOTMUCH_SORT_UNSORTED) {
-            queryloader.sort = NOTMUCH_SORT_OLDEST_FIRST;
+          notmuch_sort_t sort;
+
+          if (queryloader->sort == NOTMUCH_SORT_UNSORTED) {
+            sort = NOTMUCH_SORT_OLDEST_FIRST;
           } else {
-            int s = static_cast<int> (queryloader.sort);
+            int s = static_cast<int> (queryloader->sort);
             s++;
-            queryloader.sort = static_cast<notmuch_sort_t> (s);
+            sort = static_cast<notmuch_sort_t> (s);
           }
 
-          LOG (info) << "ti: sorting by: " << queryloader.sort_strings[static_cast<int>(queryloader.sort)];
+          LOG (info) << "ti: sorting by: " << QueryLoader::sort_strings[static_cast<int>(sort)];
 
-          list_view->set_sort_type (queryloader.sort);
-          queryloader.reload ();
+          load_query (query_string, sort);
           return true;
         });
 
@@ -198,6 +195,41 @@ namespace Astroid {
     // }}}
   }
 
+  void ThreadIndex::load_query (ustring query, notmuch_sort_t sort) {
+    detach_loader ();
+
+    queryloader = QueryLoader::get (query, sort);
+    list_store  = queryloader->list_store;
+
+    scroll->list_store = list_store;
+    list_view->set_store (list_store);
+
+    attach_loader ();
+  }
+
+  void ThreadIndex::attach_loader () {
+    queryloader->attach (list_view);
+    list_view->set_sort_type (queryloader->sort);
+
+    stats_ready_c = queryloader->stats_ready.connect (
+        sigc::mem_fun (this, &ThreadIndex::on_stats_ready));
+
+    first_thread_ready_c = queryloader->first_thread_ready.connect (
+        sigc::mem_fun (this, &ThreadIndex::on_first_thread_ready));
+
+    /* the query might already be loaded by another index */
+    if (queryloader->loaded_threads > 0) {
+      on_first_thread_ready ();
+      on_stats_ready ();
+    }
+  }
+
+  void ThreadIndex::detach_loader () {
+    stats_ready_c.disconnect ();
+    first_thread_ready_c.disconnect ();
+    queryloader->detach (list_view);
+  }
+
   void ThreadIndex::on_stats_ready () {
     set_label (get_label ());
     list_view->update_bg_image ();
@@ -206,6 +238,8 @@ namespace Astroid {
   void ThreadIndex::on_first_thread_ready () {
     /* select first */
     list_view->set_cursor (Gtk::TreePath("0"));
+
+    StartupProfile::done ();
   }
 
   ustring ThreadIndex::get_label () {
@@ -215,11 +249,11 @@ namespace Astroid {
     }
 
     if (name == "")
-      return ustring::compose ("%1 (%2/%3)%4%5", query_string, queryloader.unread_messages,
-          queryloader.total_messages, queryloader.loading() ? " (%)" : "", f);
+      return ustring::compose ("%1 (%2/%3)%4%5", query_string, queryloader->unread_messages,
+          queryloader->total_messages, queryloader->loading() ? " (%)" : "", f);
     else
       return ustring::compose ("%1 (%2/%3)%4%5", name,
-          queryloader.unread_messages, queryloader.total_messages, queryloader.loading() ? " (%)" : "", f);
+          queryloader->unread_messages, queryloader->total_messages, queryloader->loading() ? " (%)" : "", f);
   }
 
   void ThreadIndex::open_thread (refptr<NotmuchThread> thread, bool new_tab, bool new_window) {
@@ -230,17 +264,17 @@ namespace Astroid {
 
     if (new_window) {
       MainWindow * nmw = astroid->open_new_window (false);
-      tv = Gtk::manage(new ThreadView (nmw));
+      tv = ThreadViewPool::take (nmw);
       nmw->add_mode (tv);
     } else if (new_tab) {
-      tv = Gtk::manage(new ThreadView (main_window));
+      tv = ThreadViewPool::take (main_window);
       main_window->add_mode (tv);
     } else {
       LOG (debug) << "ti: init paned tv";
       if (packed == 2) {
         tv = (ThreadView *) pw2;
       } else {
-        tv = Gtk::manage(new ThreadView (main_window));
+        tv = ThreadViewPool::take (main_window);
         add_pane (1, tv);
       }
     }
@@ -311,7 +345,8 @@ namespace Astroid {
   }
 
   void ThreadIndex::pre_close () {
-    queryloader.stop (true);
+    /* the loader is stopped when no other index is using it */
+    detach_loader ();
     if (packed > 1) del_pane (1);
 # ifndef DISABLE_PLUGINS
     plugins->deactivate ();
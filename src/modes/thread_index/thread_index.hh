@@ -21,7 +21,7 @@ namespace Astroid {
       ThreadIndex (MainWindow *, ustring, ustring = "");
       ~ThreadIndex ();
 
-      QueryLoader queryloader;
+      std::shared_ptr<QueryLoader> queryloader;
 
       void open_thread (refptr<NotmuchThread>, bool new_tab, bool new_window = false);
 
@@ -45,5 +45,13 @@ namespace Astroid {
 
     private:
       void on_first_thread_ready ();
+
+      /* switch to the (possibly shared) loader for query */
+      void load_query (ustring query, notmuch_sort_t sort);
+      void attach_loader ();
+      void detach_loader ();
+
+      sigc::connection stats_ready_c;
+      sigc::connection first_thread_ready_c;
   };
 }
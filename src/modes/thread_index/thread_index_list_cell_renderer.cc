@@ -389,7 +389,7 @@ namespace Astroid {
       const Gdk::Rectangle &cell_area,
       Gtk::CellRendererState flags) {
 
-    ustring date = Date::pretty_print (thread->newest_date);
+    ustring date = Date::pretty_print_cached (thread->newest_date);
 
     Glib::RefPtr<Pango::Layout> pango_layout = widget.create_pango_layout (date);
 
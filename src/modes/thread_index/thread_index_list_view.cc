@@ -8,6 +8,7 @@
 # include "main_window.hh"
 # include "thread_index.hh"
 # include "query_loader.hh"
+# include "thread_prefetcher.hh"
 # include "thread_index_list_view.hh"
 # include "thread_index_list_cell_renderer.hh"
 # include "modes/keybindings.hh"
@@ -71,7 +72,6 @@ namespace Astroid {
     add (oldest_date);
     add (thread_id);
     add (thread);
-    add (marked);
   }
 
   ThreadIndexListStore::ThreadIndexListStore () {
@@ -94,15 +94,11 @@ namespace Astroid {
 
     thread_index    = _thread_index;
     main_window     = _thread_index->main_window;
-    list_store.clear ();
-    list_store      = store;
-    filtered_store  = Gtk::TreeModelFilter::create (list_store);
-    filtered_store->set_visible_func (sigc::mem_fun (this, &ThreadIndexListView::filter_visible_row));
+    set_store (store);
 
     config = astroid->config ("thread_index");
     page_jump_rows     = config.get<int>("page_jump_rows");
 
-    set_model (filtered_store);
     set_enable_search (false);
 
     set_show_expanders (false);
@@ -128,6 +124,10 @@ namespace Astroid {
     signal_row_activated ().connect (
         sigc::mem_fun (this, &ThreadIndexListView::on_my_row_activated));
 
+    prefetch_threads = config.get<unsigned int> ("prefetch_threads");
+    signal_cursor_changed ().connect (
+        sigc::mem_fun (this, &ThreadIndexListView::on_my_cursor_changed));
+
     /* set up popup menu {{{ */
 
     /* icon list */
@@ -239,6 +239,37 @@ namespace Astroid {
 
   ThreadIndexListView::~ThreadIndexListView () {
     LOG (debug) << "tilv: deconstruct.";
+    prefetch_c.disconnect ();
+  }
+
+  void ThreadIndexListView::on_my_cursor_changed () {
+    if (prefetch_threads == 0) return;
+
+    prefetch_c.disconnect ();
+    prefetch_c = Glib::signal_timeout ().connect (
+        sigc::mem_fun (this, &ThreadIndexListView::on_prefetch), PREFETCH_DELAY);
+  }
+
+  bool ThreadIndexListView::on_prefetch () {
+    Gtk::TreePath path;
+    Gtk::TreeViewColumn *c;
+    get_cursor (path, c);
+
+    if (!path) return false;
+
+    /* current thread and the next ones */
+    std::vector<refptr<NotmuchThread>> threads;
+    Gtk::TreeIter iter = filtered_store->get_iter (path);
+
+    for (unsigned int i = 0; iter && i <= prefetch_threads; i++, iter++) {
+      Gtk::ListStore::Row row = *iter;
+      refptr<NotmuchThread> t = row[list_store->columns.thread];
+      if (t) threads.push_back (t);
+    }
+
+    ThreadPrefetcher::prefetch (threads);
+
+    return false;
   }
 
   bool ThreadIndexListView::filter_visible_row ( const Gtk::TreeIter & iter)
@@ -283,6 +314,33 @@ namespace Astroid {
   }
 
 
+  void ThreadIndexListView::set_store (refptr<ThreadIndexListStore> store) {
+    list_store.clear ();
+    list_store      = store;
+    filtered_store  = Gtk::TreeModelFilter::create (list_store);
+    filtered_store->set_visible_func (sigc::mem_fun (this, &ThreadIndexListView::filter_visible_row));
+
+    set_model (filtered_store);
+
+    /* marks belong to the threads of the previous query */
+    marked.clear ();
+  }
+
+  bool ThreadIndexListView::is_marked (const Gtk::TreeIter & iter) {
+    Gtk::ListStore::Row row = *iter;
+    return marked.find (row[list_store->columns.thread_id]) != marked.end ();
+  }
+
+  void ThreadIndexListView::set_marked (const Gtk::TreeIter & iter, bool m) {
+    Gtk::ListStore::Row row = *iter;
+    ustring thread_id = row[list_store->columns.thread_id];
+
+    if (m) marked.insert (thread_id);
+    else   marked.erase (thread_id);
+
+    queue_draw ();
+  }
+
   void ThreadIndexListView::set_thread_data (
       Gtk::CellRenderer * renderer,
       const Gtk::TreeIter &iter) {
@@ -295,7 +353,7 @@ namespace Astroid {
 
       Gtk::ListStore::Row row = *iter;
       r->thread = row[list_store->columns.thread];
-      r->marked = row[list_store->columns.marked];
+      r->marked = is_marked (iter);
 
     }
   }
@@ -531,7 +589,7 @@ namespace Astroid {
 
             while (fwditer) {
               row = *fwditer;
-              if (row[list_store->columns.marked]) {
+              if (is_marked (fwditer)) {
                 found = true;
                 break;
               }
@@ -796,8 +854,7 @@ namespace Astroid {
           iter = filtered_store->get_iter (path);
 
           if (iter) {
-            Gtk::ListStore::Row row = *iter;
-            row[list_store->columns.marked] = !row[list_store->columns.marked];
+            set_marked (iter, !is_marked (iter));
 
             /* move to next thread */
             path.next ();
@@ -822,8 +879,7 @@ namespace Astroid {
           iter = filtered_store->get_iter (path);
 
           if (iter) {
-            Gtk::ListStore::Row row = *iter;
-            row[list_store->columns.marked] = !row[list_store->columns.marked];
+            set_marked (iter, !is_marked (iter));
           }
 
           return true;
@@ -843,8 +899,7 @@ namespace Astroid {
           iter = filtered_store->get_iter (path);
 
           if (iter) {
-            Gtk::ListStore::Row row = *iter;
-            row[list_store->columns.marked] = !row[list_store->columns.marked];
+            set_marked (iter, !is_marked (iter));
 
             /* move to previous */
             path.prev ();
@@ -864,8 +919,7 @@ namespace Astroid {
           fwditer = filtered_store->get_iter ("0");
           Gtk::ListStore::Row row;
           while (fwditer) {
-            row = *fwditer;
-            row[list_store->columns.marked] = !row[list_store->columns.marked];
+            set_marked (fwditer, !is_marked (fwditer));
             fwditer++;
           }
           return true;
@@ -1070,9 +1124,9 @@ namespace Astroid {
 
           while (fwditer) {
             row = *fwditer;
-            if (row[list_store->columns.marked]) {
+            if (is_marked (fwditer)) {
 
-              // row[list_store->columns.marked] = false;
+              // set_marked (fwditer, false);
               refptr<NotmuchThread> thread = row[list_store->columns.thread];
 
               threads.push_back (refptr<NotmuchItem>::cast_dynamic(thread));
@@ -1140,9 +1194,9 @@ namespace Astroid {
         {
           while (fwditer) {
             row = *fwditer;
-            if (row[list_store->columns.marked]) {
+            if (is_marked (fwditer)) {
 
-              row[list_store->columns.marked] = false;
+              set_marked (fwditer, false);
 
             }
 
@@ -1263,7 +1317,7 @@ namespace Astroid {
   }
 
   void ThreadIndexListView::update_bg_image () {
-    bool hide = (!filter_txt.empty () && filtered_store->children().size () == 0) || (filter_txt.empty () && thread_index->queryloader.total_messages == 0);
+    bool hide = (!filter_txt.empty () && filtered_store->children().size () == 0) || (filter_txt.empty () && thread_index->queryloader->total_messages == 0);
 
     if (!hide) {
       auto sc = get_style_context ();
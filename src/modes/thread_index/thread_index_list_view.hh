@@ -1,6 +1,7 @@
 # pragma once
 
 # include <chrono>
+# include <set>
 
 # include <gtkmm.h>
 # include <gtkmm/liststore.h>
@@ -33,7 +34,6 @@ namespace Astroid {
           Gtk::TreeModelColumn<time_t> oldest_date;
           Gtk::TreeModelColumn<Glib::ustring> thread_id;
           Gtk::TreeModelColumn<Glib::RefPtr<NotmuchThread>> thread;
-          Gtk::TreeModelColumn<bool> marked;
 
           ThreadIndexListStoreColumnRecord ();
       };
@@ -60,6 +60,10 @@ namespace Astroid {
       refptr<ThreadIndexListStore> list_store;
       refptr<Gtk::TreeModelFilter> filtered_store;
 
+      /* the list store may be shared with other indexes showing the same
+       * query, the filter and marks belong to this view. */
+      void set_store (refptr<ThreadIndexListStore>);
+
       ThreadIndexListCellRenderer * renderer;
       int page_jump_rows; // rows to jump
 
@@ -76,6 +80,10 @@ namespace Astroid {
       std::vector<ustring> filter;
       void on_filter (ustring k);
 
+      std::set<ustring> marked; // thread ids
+      bool is_marked (const Gtk::TreeIter &);
+      void set_marked (const Gtk::TreeIter &, bool);
+
 
     protected:
       Keybindings multi_keys;
@@ -114,6 +122,14 @@ namespace Astroid {
       virtual bool on_key_press_event (GdkEventKey *) override;
 
     private:
+      static const int PREFETCH_DELAY = 300; // ms
+
+      /* prefetch the threads following the cursor when it rests */
+      unsigned int prefetch_threads;
+      sigc::connection prefetch_c;
+      void on_my_cursor_changed ();
+      bool on_prefetch ();
+
       std::chrono::time_point<std::chrono::steady_clock> last_redraw;
       bool redraw ();
   };
@@ -0,0 +1,130 @@
+# include <algorithm>
+
+# include "astroid.hh"
+# include "db.hh"
+# include "message_thread.hh"
+# include "actions/action_manager.hh"
+# include "thread_prefetcher.hh"
+
+namespace Astroid {
+  std::deque<refptr<NotmuchThread>> ThreadPrefetcher::pending;
+  std::list<refptr<MessageThread>> ThreadPrefetcher::loaded;
+  refptr<MessageThread> ThreadPrefetcher::current;
+  std::deque<std::pair<int, refptr<NotmuchMessage>>> ThreadPrefetcher::current_messages;
+  bool ThreadPrefetcher::loading   = false;
+  bool ThreadPrefetcher::connected = false;
+
+  void ThreadPrefetcher::prefetch (std::vector<refptr<NotmuchThread>> threads) {
+    if (!connected) {
+      connected = true;
+
+      astroid->actions->signal_thread_changed ().connect (
+          sigc::ptr_fun (&ThreadPrefetcher::invalidate));
+
+      astroid->actions->signal_thread_updated ().connect (
+          sigc::ptr_fun (&ThreadPrefetcher::invalidate));
+
+      astroid->actions->signal_refreshed ().connect (
+          sigc::ptr_fun (&ThreadPrefetcher::clear));
+    }
+
+    pending.clear ();
+
+    for (auto &t : threads) {
+      /* encrypted threads would have to be decrypted, possibly asking
+       * for a passphrase */
+      if (t->has_tag ("encrypted")) continue;
+
+      if (t->total_messages > MAX_MESSAGES) continue;
+
+      bool have = std::any_of (loaded.begin (), loaded.end (),
+          [&] (refptr<MessageThread> &mt) { return mt->thread->thread_id == t->thread_id; });
+
+      if (current && current->thread->thread_id == t->thread_id) have = true;
+
+      if (!have) pending.push_back (t);
+    }
+
+    if (!loading && (current || !pending.empty ())) {
+      loading = true;
+      Glib::signal_idle ().connect (&ThreadPrefetcher::on_load, Glib::PRIORITY_LOW);
+    }
+  }
+
+  bool ThreadPrefetcher::on_load () {
+    /* one message per idle iteration so that the gui stays responsive */
+    if (current) {
+      if (!current_messages.empty ()) {
+        auto mm = current_messages.front ();
+        current_messages.pop_front ();
+
+        current->load_message (mm.first, mm.second);
+      }
+
+      if (current_messages.empty ()) {
+        loaded.push_front (current);
+        if (loaded.size () > MAX_LOADED) loaded.pop_back ();
+
+        current.reset ();
+      }
+
+      return true;
+    }
+
+    if (pending.empty ()) {
+      loading = false;
+      return false;
+    }
+
+    refptr<NotmuchThread> t = pending.front ();
+    pending.pop_front ();
+
+    LOG (debug) << "tp: prefetching thread: " << t->thread_id;
+
+    Db db (Db::DbMode::DATABASE_READ_ONLY);
+
+    current = refptr<MessageThread> (new MessageThread (t));
+    auto mms = current->begin_load (&db);
+    current_messages.assign (mms.begin (), mms.end ());
+
+    return true;
+  }
+
+  void ThreadPrefetcher::drop_current () {
+    current.reset ();
+    current_messages.clear ();
+  }
+
+  refptr<MessageThread> ThreadPrefetcher::take (refptr<NotmuchThread> t) {
+    auto f = std::find_if (loaded.begin (), loaded.end (),
+        [&] (refptr<MessageThread> &mt) { return mt->thread->thread_id == t->thread_id; });
+
+    if (f == loaded.end ()) {
+      /* the thread view loads it now */
+      if (current && current->thread->thread_id == t->thread_id) drop_current ();
+
+      return refptr<MessageThread> ();
+    }
+
+    LOG (debug) << "tp: using prefetched thread: " << t->thread_id;
+
+    refptr<MessageThread> mt = *f;
+    loaded.erase (f);
+
+    return mt;
+  }
+
+  void ThreadPrefetcher::invalidate (Db *, ustring thread_id) {
+    loaded.remove_if (
+        [&] (refptr<MessageThread> &mt) { return mt->thread->thread_id == thread_id; });
+
+    if (current && current->thread->thread_id == thread_id) drop_current ();
+  }
+
+  void ThreadPrefetcher::clear () {
+    pending.clear ();
+    loaded.clear ();
+    drop_current ();
+  }
+}
+
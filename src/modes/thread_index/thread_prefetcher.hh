@@ -0,0 +1,45 @@
+# pragma once
+
+# include <vector>
+# include <list>
+# include <deque>
+# include <utility>
+
+# include "proto.hh"
+
+namespace Astroid {
+  /* loads the threads following the cursor in the thread index while the
+   * gui is idle, so that opening the next thread does not have to wait for
+   * the messages to be read and parsed. */
+  class ThreadPrefetcher {
+    public:
+      /* replace the threads waiting to be loaded */
+      static void prefetch (std::vector<refptr<NotmuchThread>>);
+
+      /* take a loaded thread, or NULL if it has not been loaded */
+      static refptr<MessageThread> take (refptr<NotmuchThread>);
+
+      static void clear ();
+
+    private:
+      static const unsigned int MAX_LOADED = 10;
+
+      /* threads with more messages are not prefetched */
+      static const int MAX_MESSAGES = 50;
+
+      static std::deque<refptr<NotmuchThread>> pending;
+      static std::list<refptr<MessageThread>> loaded; // most recent first
+
+      /* the thread being loaded, one message per idle iteration */
+      static refptr<MessageThread> current;
+      static std::deque<std::pair<int, refptr<NotmuchMessage>>> current_messages;
+
+      static bool loading;
+      static bool connected;
+
+      static bool on_load ();
+      static void drop_current ();
+      static void invalidate (Db *, ustring);
+  };
+}
+
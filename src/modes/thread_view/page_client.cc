@@ -256,12 +256,18 @@ namespace Astroid {
     state.set_edit_mode (thread_view->edit_mode);
 
     for (refptr<Message> &ms : thread_view->mthread->messages) {
+      ThreadView::MessageState &s = thread_view->state[ms];
+
+      /* messages not yet loaded are represented by the placeholder
+       * of their first message */
+      if (!s.loaded && s.placeholder != ms) continue;
+
       AstroidMessages::State::MessageState * m = state.add_messages ();
 
       m->set_mid (ms->safe_mid ());
-      m->set_level (ms->level);
+      m->set_level (s.loaded ? ms->level : 0);
 
-      for (auto &e : thread_view->state[ms].elements) {
+      for (auto &e : s.elements) {
         AstroidMessages::State::MessageState::Element * _e = m->add_elements ();
 
         auto ref = _e->GetReflection();
@@ -358,9 +364,24 @@ namespace Astroid {
         );
   }
 
-  void PageClient::add_message (refptr<Message> m) {
+  void PageClient::add_message (refptr<Message> m, refptr<Message> before) {
+    AstroidMessages::Message msg = make_message (m);
+    if (before) msg.set_insert_before (before->safe_mid ());
+
+    handle_ack (
+        AeProtocol::send_message_sync (AeProtocol::MessageTypes::AddMessage, msg, ostream, m_ostream, istream, m_istream)
+        );
+  }
+
+  void PageClient::add_placeholder (refptr<Message> first, int count, ustring summary, refptr<Message> before) {
+    AstroidMessages::Placeholder msg;
+    msg.set_mid (first->safe_mid ());
+    msg.set_count (count);
+    msg.set_summary (summary);
+    if (before) msg.set_insert_before (before->safe_mid ());
+
     handle_ack (
-        AeProtocol::send_message_sync (AeProtocol::MessageTypes::AddMessage, make_message (m), ostream, m_ostream, istream, m_istream)
+        AeProtocol::send_message_sync (AeProtocol::MessageTypes::Placeholder, msg, ostream, m_ostream, istream, m_istream)
         );
   }
 
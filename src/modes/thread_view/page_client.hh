@@ -29,7 +29,8 @@ namespace Astroid {
 
       /* ThreadView interface */
       void load ();
-      void add_message (refptr<Message> m);
+      void add_message (refptr<Message> m, refptr<Message> before = refptr<Message> ());
+      void add_placeholder (refptr<Message> first, int count, ustring summary, refptr<Message> before);
       void update_message (refptr<Message> m, AstroidMessages::UpdateMessage_Type t);
       void remove_message (refptr<Message> m);
       void update_state ();
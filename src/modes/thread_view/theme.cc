@@ -36,14 +36,35 @@ namespace Astroid {
   ustring Theme::thread_view_html;
   ustring Theme::thread_view_css;
   ustring Theme::part_css;
+  std::mutex Theme::load_m;
+  std::future<void> Theme::preloading;
 
   Theme::Theme () {
     load (false);
   }
 
+  void Theme::preload () {
+    /* load the theme before the first thread view needs it */
+    if (theme_loaded || preloading.valid ()) return;
+
+    preloading = std::async (std::launch::async, [] {
+        try {
+          Theme t;
+        } catch (std::exception &ex) {
+          /* the thread view will try again and report the error */
+          LOG (warn) << "theme: preloading failed: " << ex.what ();
+        }
+      });
+  }
+
+  void Theme::wait_preload () {
+    if (preloading.valid ()) preloading.wait ();
+  }
+
   void Theme::load (bool reload) {
     using bfs::path;
     using std::endl;
+    std::lock_guard<std::mutex> lk (load_m);
     LOG (debug) << "theme: loading..";
 
     /* load html and css (from scss) */
@@ -92,8 +113,8 @@ namespace Astroid {
 
       /* load style sheet */
 # ifndef DISABLE_LIBSASS
-      thread_view_css = process_scss (tv_scss.c_str ());
-      part_css        = process_scss (part_scss.c_str ());
+      thread_view_css = cached_scss (tv_scss);
+      part_css        = cached_scss (part_scss);
 # else
       {
         std::ifstream tv_css_f (tv_css.c_str());
@@ -119,6 +140,97 @@ namespace Astroid {
   }
 
 # ifndef DISABLE_LIBSASS
+  ustring Theme::cached_scss (bfs::path scss) {
+    /* the compiled css is stored in the cache directory together with a
+     * hash of the sources and the compiler version, it is only used if
+     * the hash still matches. */
+    path cache = astroid->standard_paths ().cache_dir / path ("theme") / path (scss.stem ().string () + ".css");
+
+    Glib::Checksum sum (Glib::Checksum::CHECKSUM_SHA256);
+    sum.update (libsass_version ());
+    sum.update (ustring::compose ("%1", THEME_VERSION));
+    hash_scss (scss, sum, 0);
+
+    ustring key = "/* astroid-theme: " + sum.get_string () + " */";
+
+    if (exists (cache)) {
+      std::ifstream f (cache.c_str ());
+      std::string first;
+      std::getline (f, first);
+
+      if (first == key) {
+        LOG (debug) << "theme: using cached css: " << cache.c_str ();
+
+        std::istreambuf_iterator<char> eos;
+        std::istreambuf_iterator<char> iit (f);
+        return ustring (std::string (iit, eos));
+      }
+
+      LOG (debug) << "theme: cached css is stale: " << cache.c_str ();
+    }
+
+    ustring css = process_scss (scss.c_str ());
+
+    /* write to temporary file and move in place */
+    try {
+      create_directories (cache.parent_path ());
+
+      path tmp = cache;
+      tmp += ".tmp";
+
+      {
+        std::ofstream f (tmp.c_str ());
+        f << key << endl << css;
+      }
+
+      bfs::rename (tmp, cache);
+
+    } catch (filesystem_error &ex) {
+      LOG (warn) << "theme: could not write css cache: " << ex.what ();
+    }
+
+    return css;
+  }
+
+  void Theme::hash_scss (bfs::path scss, Glib::Checksum & sum, int depth) {
+    std::ifstream f (scss.c_str ());
+    std::string src ((std::istreambuf_iterator<char> (f)), std::istreambuf_iterator<char> ());
+    sum.update (scss.string ());
+    sum.update (src);
+
+    if (depth > 10) return;
+
+    /* include any local @import's, they are looked up relative to the
+     * importing file as: name, name.scss, _name.scss and name.css. */
+    size_t i = 0;
+    while ((i = src.find ("@import", i)) != std::string::npos) {
+      size_t e = src.find (';', i);
+      if (e == std::string::npos) break;
+
+      std::string imports = src.substr (i + 7, e - i - 7);
+      i = e;
+
+      size_t q = 0;
+      while ((q = imports.find_first_of ("\"'", q)) != std::string::npos) {
+        size_t qe = imports.find (imports[q], q + 1);
+        if (qe == std::string::npos) break;
+
+        path name (imports.substr (q + 1, qe - q - 1));
+        q = qe + 1;
+
+        path dir = scss.parent_path () / name.parent_path ();
+        std::string n = name.filename ().string ();
+
+        for (auto c : { n, n + ".scss", "_" + n + ".scss", n + ".css" }) {
+          if (is_regular_file (dir / c)) {
+            hash_scss (dir / c, sum, depth + 1);
+            break;
+          }
+        }
+      }
+    }
+  }
+
   ustring Theme::process_scss (const char * scsspath) {
     /* - https://github.com/sass/libsass/blob/master/docs/api-doc.md
      * - https://github.com/sass/libsass/blob/master/docs/api-context-example.md
@@ -1,7 +1,10 @@
 # pragma once
 
 # include <atomic>
+# include <mutex>
+# include <future>
 # include <boost/filesystem.hpp>
+# include <glibmm.h>
 
 # include "proto.hh"
 
@@ -14,6 +17,10 @@ namespace Astroid {
 
       void load (bool reload);
 
+      /* load theme in the background */
+      static void preload ();
+      static void wait_preload ();
+
       static std::atomic<bool> theme_loaded;
       static const char *  thread_view_html_f;
 # ifndef DISABLE_LIBSASS
@@ -30,8 +37,13 @@ namespace Astroid {
       const int THEME_VERSION = 5;
 
     private:
+      static std::mutex load_m;
+      static std::future<void> preloading;
+
       bool check_theme_version (bfs::path);
 # ifndef DISABLE_LIBSASS
+      ustring cached_scss (bfs::path scss);
+      void    hash_scss (bfs::path scss, Glib::Checksum &, int depth);
       ustring process_scss (const char * scsspath);
 # endif
   };
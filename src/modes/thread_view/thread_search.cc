@@ -0,0 +1,306 @@
+# include <vector>
+# include <map>
+# include <set>
+# include <string>
+# include <algorithm>
+# include <functional>
+# include <chrono>
+
+# include "thread_search.hh"
+
+# include "astroid.hh"
+# include "message_thread.hh"
+# include "chunk.hh"
+# include "utils/address.hh"
+
+using namespace std;
+
+namespace Astroid {
+  ThreadSearch::ThreadSearch () {
+  }
+
+  ThreadSearch::Match::Match (refptr<Message> m, int c, std::string::size_type o) :
+    message (m), chunk (c), offset (o)
+  {
+  }
+
+  unsigned int ThreadSearch::search (refptr<MessageThread> mthread, ustring q) {
+    clear ();
+
+    if (!mthread || q.empty ()) return 0;
+
+    auto t0 = chrono::steady_clock::now ();
+
+    std::string needle = q.casefold ().raw ();
+
+    for (auto &m : mthread->messages) {
+      find_all (m, -1, get_header_text (m), needle);
+
+      if (m->missing_content) continue;
+
+      for (auto &c : displayed_parts (m)) {
+        find_all (m, c->id, get_part_text (c), needle);
+      }
+    }
+
+    LOG (debug) << "search: " << matches.size () << " matches in " << mthread->messages.size () << " messages, took: " << chrono::duration_cast<chrono::microseconds> (chrono::steady_clock::now () - t0).count () << " us.";
+
+    return matches.size ();
+  }
+
+  void ThreadSearch::find_all (refptr<Message> m, int chunk, const std::string & haystack, const std::string & needle) {
+    std::string::size_type pos = haystack.find (needle);
+
+    while (pos != std::string::npos) {
+      matches.push_back (Match (m, chunk, pos));
+      pos = haystack.find (needle, pos + needle.size ());
+    }
+  }
+
+  bool ThreadSearch::has_match (refptr<Message> m) {
+    return any_of (matches.begin (), matches.end (),
+        [&] (const Match & mt) { return mt.message == m; });
+  }
+
+  const ThreadSearch::Match * ThreadSearch::current () {
+    if (matches.empty () || current_match < 0) return NULL;
+
+    return &(matches[current_match]);
+  }
+
+  const ThreadSearch::Match * ThreadSearch::next () {
+    if (matches.empty ()) return NULL;
+
+    current_match = (current_match + 1) % matches.size ();
+    return current ();
+  }
+
+  const ThreadSearch::Match * ThreadSearch::previous () {
+    if (matches.empty ()) return NULL;
+
+    if (current_match <= 0) current_match = matches.size () - 1;
+    else                    current_match--;
+
+    return current ();
+  }
+
+  void ThreadSearch::seek (refptr<MessageThread> mthread, refptr<Message> m) {
+    if (matches.empty ()) {
+      current_match = -1;
+      return;
+    }
+
+    current_match = 0;
+    if (!m) return;
+
+    auto pos = find (mthread->messages.begin (), mthread->messages.end (), m);
+
+    /* matches are in thread order: take the first one in a message at or
+     * after the focused message. */
+    for (unsigned int i = 0; i < matches.size (); i++) {
+      auto mpos = find (mthread->messages.begin (), pos, matches[i].message);
+      if (mpos == pos) {
+        current_match = i;
+        return;
+      }
+    }
+  }
+
+  void ThreadSearch::clear () {
+    matches.clear ();
+    current_match = -1;
+  }
+
+  void ThreadSearch::reset () {
+    clear ();
+    part_text.clear ();
+    header_text.clear ();
+  }
+
+  const std::string & ThreadSearch::get_header_text (refptr<Message> m) {
+    auto h = header_text.find (m.operator->());
+
+    if (h == header_text.end ()) {
+      ustring t = m->subject + "\n" + m->sender + "\n";
+
+      if (!m->missing_content) {
+        t += AddressList (m->to ()).str () + "\n";
+        t += AddressList (m->cc ()).str () + "\n";
+      }
+
+      h = header_text.insert (std::make_pair (m.operator->(), t.casefold ().raw ())).first;
+    }
+
+    return h->second;
+  }
+
+  const std::string & ThreadSearch::get_part_text (refptr<Chunk> c) {
+    auto p = part_text.find (c->id);
+
+    if (p == part_text.end ()) {
+      ustring t;
+
+      try {
+        t = c->viewable_text (false, false);
+      } catch (Glib::ConvertError &ex) {
+        LOG (error) << "search: could not decode part: " << c->id;
+      }
+
+      if (c->is_content_type ("text", "html")) {
+        t = strip_html (t);
+      }
+
+      p = part_text.insert (std::make_pair (c->id, t.casefold ().raw ())).first;
+    }
+
+    return p->second;
+  }
+
+  std::vector<refptr<Chunk>> ThreadSearch::displayed_parts (refptr<Message> m) {
+    /* the parts shown in the thread view when the message is expanded,
+     * the same selection as PageClient::build_mime_tree. */
+    std::vector<refptr<Chunk>> parts;
+
+    function< void (refptr<Chunk>) > app_part =
+      [&] (refptr<Chunk> c)
+    {
+      if (c->attachment) return;
+
+      if (c->viewable) {
+        if (c->preferred || c->siblings.empty ()) {
+          parts.push_back (c);
+        }
+        return;
+      }
+
+      for_each (c->kids.begin (),
+                c->kids.end (),
+                app_part);
+    };
+
+    if (m->root) app_part (m->root);
+
+    return parts;
+  }
+
+  std::string ThreadSearch::strip_html (const ustring & h) {
+    /* only the text between tags is interesting for matching, entities
+     * are decoded so that they match what is shown. style and script
+     * elements are not shown, and tags other than inline ones separate
+     * the text on either side. */
+    static const std::set<std::string> inline_tags = {
+      "a", "abbr", "b", "code", "em", "font", "i", "mark", "s", "small",
+      "span", "strike", "strong", "sub", "sup", "tt", "u",
+    };
+
+    const std::string & r = h.raw ();
+    std::string out;
+    out.reserve (r.size ());
+
+    for (std::string::size_type i = 0; i < r.size (); i++) {
+      char c = r[i];
+
+      if (c == '<') {
+        std::string::size_type e;
+
+        if (r.compare (i, 4, "<!--") == 0) {
+          e = r.find ("-->", i);
+          if (e != std::string::npos) e += 2;
+
+        } else {
+          e = r.find ('>', i);
+
+          std::string::size_type n = i + 1;
+          if (n < r.size () && r[n] == '/') n++;
+
+          std::string name;
+          while (n < r.size () && g_ascii_isalnum (r[n])) {
+            name += g_ascii_tolower (r[n++]);
+          }
+
+          if (r[i + 1] != '/' && (name == "style" || name == "script")) {
+            /* skip to the end of the closing tag */
+            std::string::size_type k = e;
+            while (k != std::string::npos) {
+              k = r.find ("</", k);
+              if (k == std::string::npos ||
+                  g_ascii_strncasecmp (r.c_str () + k + 2, name.c_str (), name.size ()) == 0) break;
+              k += 2;
+            }
+
+            e = (k == std::string::npos) ? k : r.find ('>', k);
+          }
+
+          if (!inline_tags.count (name) && !out.empty () && out.back () != ' ') {
+            out += ' ';
+          }
+        }
+
+        if (e == std::string::npos) break;
+        i = e;
+
+      } else if (c == '&') {
+        std::string::size_type e = r.find (';', i);
+
+        if (e != std::string::npos && e - i <= MAX_ENTITY_LEN) {
+          std::string d = decode_entity (r.substr (i + 1, e - i - 1));
+
+          if (!d.empty ()) {
+            out += d;
+            i = e;
+            continue;
+          }
+        }
+
+        out += c;
+      } else {
+        out += c;
+      }
+    }
+
+    return out;
+  }
+
+  std::string ThreadSearch::decode_entity (const std::string & e) {
+    /* returns the utf-8 text of the entity, or an empty string if it is
+     * not known */
+    static const std::map<std::string, gunichar> named = {
+      { "amp",    '&' },
+      { "lt",     '<' },
+      { "gt",     '>' },
+      { "quot",   '"' },
+      { "apos",   '\'' },
+      { "nbsp",   ' ' },
+      { "ndash",  0x2013 },
+      { "mdash",  0x2014 },
+      { "lsquo",  0x2018 },
+      { "rsquo",  0x2019 },
+      { "ldquo",  0x201c },
+      { "rdquo",  0x201d },
+      { "hellip", 0x2026 },
+    };
+
+    gunichar u = 0;
+
+    if (e.size () > 1 && e[0] == '#') {
+      try {
+        if (e[1] == 'x' || e[1] == 'X') u = std::stoul (e.substr (2), NULL, 16);
+        else                            u = std::stoul (e.substr (1), NULL, 10);
+      } catch (std::exception &) {
+        return "";
+      }
+    } else {
+      auto n = named.find (e);
+      if (n == named.end ()) return "";
+      u = n->second;
+    }
+
+    if (u == 0 || !g_unichar_validate (u)) return "";
+
+    char buf[6];
+    int len = g_unichar_to_utf8 (u, buf);
+
+    return std::string (buf, len);
+  }
+}
+
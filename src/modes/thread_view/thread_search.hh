@@ -0,0 +1,66 @@
+# pragma once
+
+# include <vector>
+# include <map>
+# include <string>
+
+# include "proto.hh"
+
+namespace Astroid {
+  /* Searches the decoded text parts and headers of the messages in a
+   * thread without involving the web view. The text of each part is
+   * decoded and case folded once and kept until the thread is reset, so
+   * repeated searches in the same thread only do string matching.
+   */
+  class ThreadSearch {
+    public:
+      ThreadSearch ();
+
+      struct Match {
+        public:
+          Match (refptr<Message>, int, std::string::size_type);
+
+          refptr<Message>         message;
+          int                     chunk;  /* chunk id, -1 for headers */
+          std::string::size_type  offset; /* byte offset in the case folded text */
+      };
+
+      /* search all messages in the thread, returns number of matches */
+      unsigned int search (refptr<MessageThread>, ustring q);
+
+      std::vector<Match> matches;
+      bool has_match (refptr<Message>);
+
+      /* step through the matches (wrapping around), returns NULL if
+       * there are no matches */
+      const Match * current ();
+      const Match * next ();
+      const Match * previous ();
+
+      /* start at the first match in or after the message */
+      void seek (refptr<MessageThread>, refptr<Message>);
+
+      /* forget matches, keep decoded text */
+      void clear ();
+
+      /* forget everything, must be called when the thread is reloaded */
+      void reset ();
+
+    private:
+      int current_match = -1;
+
+      std::map<int, std::string>              part_text;
+      std::map<Message *, std::string>        header_text;
+
+      const std::string & get_part_text (refptr<Chunk>);
+      const std::string & get_header_text (refptr<Message>);
+
+      std::vector<refptr<Chunk>> displayed_parts (refptr<Message>);
+      static std::string strip_html (const ustring &);
+      static std::string decode_entity (const std::string &);
+      static const std::string::size_type MAX_ENTITY_LEN = 10;
+
+      void find_all (refptr<Message>, int, const std::string & haystack, const std::string & needle);
+  };
+}
+
@@ -43,6 +43,7 @@
 # include "modes/forward_message.hh"
 # include "modes/raw_message.hh"
 # include "modes/thread_index/thread_index.hh"
+# include "modes/thread_index/thread_prefetcher.hh"
 # include "theme.hh"
 
 using namespace std;
@@ -54,6 +55,12 @@ namespace Astroid {
     edit_mode = _edit_mode;
     wk_loaded = false;
     ready = false;
+    saving = false;
+    save_cancel = false;
+    save_failed = false;
+
+    save_progress.connect (
+        sigc::mem_fun (this, &ThreadView::on_save_progress));
 
     /* home uri used for thread view - request will be relative this
      * non-existant (hopefully) directory. */
@@ -76,6 +83,9 @@ namespace Astroid {
 
     expand_flagged = config.get<bool> ("expand_flagged");
 
+    window_threshold = config.get<unsigned int> ("window_threshold");
+    window_size      = std::max (1u, config.get<unsigned int> ("window_size"));
+
     page_client->enable_gravatar = config.get<bool>("gravatar.enable");
     unread_delay = config.get<double>("mark_unread_delay");
 
@@ -143,6 +153,10 @@ namespace Astroid {
 
   ThreadView::~ThreadView () { //
     LOG (debug) << "tv: deconstruct.";
+
+    save_cancel = true;
+    if (save_thread.joinable ()) save_thread.join ();
+
     g_object_unref (context);
     g_object_unref (websettings);
     g_object_unref (webview);
@@ -157,6 +171,10 @@ namespace Astroid {
     delete page_client;
   }
 
+  bool ThreadView::is_loaded () {
+    return wk_loaded && page_client->ready;
+  }
+
   /* navigation requests  */
   extern "C" gboolean ThreadView_decide_policy (
       WebKitWebView * w,
@@ -322,10 +340,14 @@ namespace Astroid {
 
     set_label (thread->thread_id);
 
-    Db db (Db::DbMode::DATABASE_READ_ONLY);
+    auto _mthread = ThreadPrefetcher::take (thread);
 
-    auto _mthread = refptr<MessageThread>(new MessageThread (thread));
-    _mthread->load_messages (&db);
+    if (!_mthread) {
+      Db db (Db::DbMode::DATABASE_READ_ONLY);
+
+      _mthread = refptr<MessageThread>(new MessageThread (thread));
+      _mthread->load_messages (&db);
+    }
 
     if (unread_setup) unread_checker.disconnect ();
     unread_setup = false; // reset
@@ -336,6 +358,10 @@ namespace Astroid {
   void ThreadView::load_message_thread (refptr<MessageThread> _mthread) {
     ready = false;
 
+    in_search = false;
+    search_q  = "";
+    searcher.reset ();
+
     mthread.clear ();
     mthread = _mthread;
 
@@ -362,8 +388,10 @@ namespace Astroid {
           refptr<Message> _m = refptr<Message> (m);
           _m->reference (); // since m is owned by caller
 
-          page_client->update_message (_m, AstroidMessages::UpdateMessage_Type_Tags);
-          page_client->update_state ();
+          if (state[_m].loaded) {
+            page_client->update_message (_m, AstroidMessages::UpdateMessage_Type_Tags);
+            page_client->update_state ();
+          }
         }
 
       }
@@ -377,6 +405,42 @@ namespace Astroid {
         _m->reference (); // since m is owned by caller
 
         LOG (debug) << "tv: remove message: " << m->mid;
+
+        bool loaded = state[_m].loaded;
+
+        if (!loaded) {
+          /* drop the message from its placeholder, the placeholder is
+           * replaced to update its summary and (possibly) its id */
+          refptr<Message> first = state[_m].placeholder;
+          Placeholder p = placeholders[first];
+          placeholders.erase (first);
+
+          p.messages.erase (std::find (p.messages.begin (), p.messages.end (), _m));
+          page_client->remove_message (first);
+
+          if (!p.messages.empty ()) {
+            for (auto &mm : p.messages) state[mm].placeholder = p.messages.front ();
+            placeholders[p.messages.front ()] = p;
+
+            page_client->add_placeholder (p.messages.front (),
+                p.messages.size (), placeholder_summary (p), p.before);
+          }
+        }
+
+        /* placeholders that were inserted before the removed message
+         * go before the message following them now */
+        for (auto &p : placeholders) {
+          if (p.second.before == _m) {
+            auto it = std::find (mthread->messages.begin (),
+                                 mthread->messages.end (),
+                                 p.second.messages.back ());
+
+            if (it != mthread->messages.end ()) it++;
+
+            p.second.before = (it != mthread->messages.end ()) ? *it : refptr<Message> ();
+          }
+        }
+
         state.erase (_m);
 
         /* check if message has been removed from messagethread, if not
@@ -388,7 +452,7 @@ namespace Astroid {
           }
         }
 
-        page_client->remove_message (_m);
+        if (loaded) page_client->remove_message (_m);
         page_client->update_state ();
       }
     }
@@ -423,6 +487,7 @@ namespace Astroid {
 
     /* set message state vector */
     state.clear ();
+    placeholders.clear ();
     focused_message.clear ();
 
     if (mthread) {
@@ -430,6 +495,25 @@ namespace Astroid {
         add_message (m);
       }
 
+      if (!edit_mode && window_threshold > 0 &&
+          mthread->messages.size () > window_threshold) {
+        window_messages ();
+      }
+
+      for (auto &m : mthread->messages) {
+        MessageState &s = state[m];
+
+        if (s.loaded) {
+          render_message (m);
+        } else if (s.placeholder == m) {
+          /* rendered in order, so it is appended like the messages */
+          page_client->add_placeholder (m,
+              placeholders[m].messages.size (),
+              placeholder_summary (placeholders[m]),
+              refptr<Message> ());
+        }
+      }
+
       page_client->update_state ();
       update_all_indent_states ();
 
@@ -486,8 +570,10 @@ namespace Astroid {
 
     m->signal_message_changed ().connect (
         sigc::mem_fun (this, &ThreadView::on_message_changed));
+  }
 
-    page_client->add_message (m);
+  void ThreadView::render_message (refptr<Message> m, refptr<Message> before) {
+    page_client->add_message (m, before);
 
     if (!edit_mode) {
       /* optionally hide / collapse the message */
@@ -520,6 +606,141 @@ namespace Astroid {
     }
   }
 
+  void ThreadView::window_messages () {
+    /* keep the messages around the one that will be focused, the unread
+     * and the expanded flagged messages. the others are grouped into
+     * placeholders of at most window_size messages. */
+    auto &msgs = mthread->messages;
+
+    refptr<Message> center;
+    for (auto &m : mthread->messages_by_time ()) {
+      if (m->has_tag ("unread")) {
+        center = m;
+        break;
+      }
+    }
+
+    if (!center) {
+      center = *max_element (msgs.begin (), msgs.end (),
+          [](refptr<Message> &a, refptr<Message> &b)
+            {
+              return ( a->time < b->time );
+            });
+    }
+
+    int c = std::find (msgs.begin (), msgs.end (), center) - msgs.begin ();
+
+    refptr<Message> first;
+    unsigned int hidden = 0;
+
+    for (int i = 0; i < static_cast<int>(msgs.size ()); i++) {
+      refptr<Message> m = msgs[i];
+
+      if (std::abs (i - c) <= static_cast<int>(window_size) ||
+          m->has_tag ("unread") ||
+          (expand_flagged && m->has_tag ("flagged"))) {
+
+        if (first) placeholders[first].before = m;
+        first.clear ();
+        continue;
+      }
+
+      if (!first || placeholders[first].messages.size () >= window_size) {
+        if (first) placeholders[first].before = m;
+        first = m;
+      }
+
+      MessageState &s = state[m];
+      s.loaded      = false;
+      s.expanded    = false;
+      s.placeholder = first;
+
+      placeholders[first].messages.push_back (m);
+      hidden++;
+    }
+
+    LOG (info) << "tv: large thread (" << msgs.size () << " messages), " << hidden << " messages in " << placeholders.size () << " placeholders.";
+  }
+
+  ustring ThreadView::placeholder_summary (Placeholder & p) {
+    std::vector<ustring> senders;
+
+    for (auto &m : p.messages) {
+      ustring s = Address (m->sender).fail_safe_name ();
+
+      if (std::find (senders.begin (), senders.end (), s) == senders.end ()) {
+        senders.push_back (s);
+      }
+    }
+
+    unsigned int others = 0;
+    if (senders.size () > 3) {
+      others = senders.size () - 3;
+      senders.resize (3);
+    }
+
+    ustring from = VectorUtils::concat (senders, ", ");
+    if (others > 0) {
+      from += ustring::compose (" and %1 others", others);
+    }
+
+    auto span = std::minmax_element (p.messages.begin (), p.messages.end (),
+        [](const refptr<Message> &a, const refptr<Message> &b)
+          {
+            return ( a->time < b->time );
+          });
+
+    ustring dates = (*span.first)->pretty_date ();
+    if ((*span.second)->pretty_date () != dates) {
+      dates += " - " + (*span.second)->pretty_date ();
+    }
+
+    return ustring::compose ("%1 more messages from %2 (%3)",
+        p.messages.size (), from, dates);
+  }
+
+  void ThreadView::load_placeholder (refptr<Message> m) {
+    auto f = placeholders.find (state[m].placeholder);
+    if (f == placeholders.end ()) return;
+
+    Placeholder p = f->second;
+    placeholders.erase (f);
+
+    LOG (debug) << "tv: loading placeholder: " << p.messages.size () << " messages.";
+
+    /* the placeholder has the id of its first message */
+    page_client->remove_message (p.messages.front ());
+
+    for (auto &mm : p.messages) {
+      MessageState &s = state[mm];
+      s.loaded = true;
+      s.placeholder.clear ();
+
+      render_message (mm, p.before);
+
+      if (s.marked) page_client->set_marked_state (mm, true);
+    }
+
+    page_client->update_state ();
+    update_all_indent_states ();
+
+    if (in_search) {
+      /* expand and highlight the matches in the new messages */
+      for (auto &mm : p.messages) {
+        if (searcher.has_match (mm)) {
+          state[mm].search_expanded = !expand (mm);
+        }
+      }
+
+      WebKitFindController * fc = webkit_web_view_get_find_controller (webview);
+
+      webkit_find_controller_search (fc, search_q.c_str (),
+          WEBKIT_FIND_OPTIONS_CASE_INSENSITIVE |
+          WEBKIT_FIND_OPTIONS_WRAP_AROUND,
+          G_MAXUINT);
+    }
+  }
+
   /* info and warning  */
   void ThreadView::set_warning (refptr<Message> m, ustring txt)
   {
@@ -726,6 +947,8 @@ namespace Astroid {
         "Mark or unmark message",
         [&] (Key) {
           if (!edit_mode) {
+            if (!state[focused_message].loaded) load_placeholder (focused_message);
+
             state[focused_message].marked = !(state[focused_message].marked);
             page_client->set_marked_state (focused_message, state[focused_message].marked);
             return true;
@@ -757,7 +980,10 @@ namespace Astroid {
               } else {
                 s.second.marked = !s.second.marked;
               }
-              page_client->set_marked_state (s.first, s.second.marked);
+
+              if (s.second.loaded) {
+                page_client->set_marked_state (s.first, s.second.marked);
+              }
             }
 
 
@@ -1092,7 +1318,7 @@ namespace Astroid {
             MessageState    s = ms.second;
             if (s.marked) {
               state[m].marked = false;
-              page_client->set_marked_state (m, state[m].marked);
+              if (s.loaded) page_client->set_marked_state (m, state[m].marked);
             }
           }
           return true;
@@ -1943,6 +2169,8 @@ namespace Astroid {
     if (m) {
       LOG (debug) << "tv: focus message: " << m->safe_mid () << ", element: " << e;
 
+      if (!state[m].loaded) load_placeholder (m);
+
       page_client->focus_element (m, e);
     }
   }
@@ -1957,6 +2185,8 @@ namespace Astroid {
     /* returns true if the message was expanded in the first place */
     bool wasexpanded  = state[m].expanded;
 
+    if (!state[m].loaded) load_placeholder (m);
+
     state[m].expanded = true;
     page_client->set_hidden_state (m, false);
 
@@ -1972,7 +2202,7 @@ namespace Astroid {
     /* returns true if the message was expanded in the first place */
     bool wasexpanded  = state[m].expanded;
 
-    page_client->set_hidden_state (m, true);
+    if (state[m].loaded) page_client->set_hidden_state (m, true);
     state[m].expanded = false;
 
 
@@ -1997,6 +2227,13 @@ namespace Astroid {
       return;
     }
 
+    if (saving) {
+      ask_yes_no ("Cancel saving attachments?", [&] (bool yes) {
+          if (yes) save_cancel = true;
+        });
+      return;
+    }
+
     auto attachments = focused_message->attachments ();
     if (attachments.empty ()) {
       LOG (warn) << "tv: this message has no attachments to save.";
@@ -2023,10 +2260,41 @@ namespace Astroid {
           /* TODO: check if the file exists and ask to overwrite. currently
            *       we are failing silently (except an error message in the log)
            */
-          for (refptr<Chunk> a : attachments) {
-            a->save_to (dir);
+          if (save_thread.joinable ()) save_thread.join ();
+
+          save_failed  = false;
+
+          /* the chunks share gmime objects and the file handle of the
+           * message with the rest of astroid, the worker gets streams of
+           * its own. */
+          ustring message_file = focused_message->has_file ? focused_message->fname : "";
+          std::vector<SaveJob> jobs;
+
+          for (auto &a : attachments) {
+            std::string to = a->save_path (dir);
+
+            /* attachments with the same name would be written at the same
+             * time, the first one is kept */
+            bool taken = std::any_of (jobs.begin (), jobs.end (),
+                [&] (SaveJob &j) { return j.to == to; });
+
+            if (to.empty () || taken) {
+              if (taken) LOG (error) << "tv: save: another attachment is saved to: " << to;
+              save_failed = true;
+              continue;
+            }
+
+            SaveJob j;
+            j.to     = to;
+            j.stream = a->detached_stream (message_file, j.encoding);
+            jobs.push_back (j);
           }
 
+          saving       = true;
+          save_cancel  = false;
+          save_message = focused_message;
+          save_thread  = std::thread (&ThreadView::save_attachments_worker, this, jobs, dir);
+
           break;
         }
 
@@ -2037,6 +2305,83 @@ namespace Astroid {
     }
   } //
 
+  void ThreadView::save_attachments_worker (std::vector<SaveJob> attachments, std::string dir) {
+    /* every job has its own streams, so they are saved in parallel by up to
+     * SAVE_THREADS threads */
+    std::atomic<unsigned int> next  { 0 };
+    std::atomic<unsigned int> saved { 0 };
+    std::atomic<gint64>       total { 0 };
+    gint64 last = 0;
+
+    auto save = [&] () {
+      unsigned int i;
+
+      while (!save_cancel && (i = next++) < attachments.size ()) {
+        auto &a = attachments[i];
+        gint64 part = 0;
+
+        bool r = Chunk::save_stream (a.stream, a.encoding, a.to, false, [&] (gint64 written) {
+            gint64 t = (total += written - part);
+            part = written;
+
+            /* limit status updates to every few MB */
+            std::lock_guard<std::mutex> lk (save_m);
+            if (t - last >= 4 * 1024 * 1024) {
+              last = t;
+
+              save_status = ustring::compose ("Saving attachments, %1 of %2 done (%3)..",
+                  saved.load (), attachments.size (), Utils::format_size (t));
+              save_progress.emit ();
+            }
+
+            return !save_cancel.load ();
+          });
+
+        if (r) {
+          saved++;
+        } else {
+          std::lock_guard<std::mutex> lk (save_m);
+          save_failed = true;
+        }
+      }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < SAVE_THREADS && i < attachments.size (); i++) pool.push_back (std::thread (save));
+
+    save ();
+
+    for (auto &t : pool) t.join ();
+
+    for (auto &a : attachments) g_object_unref (a.stream);
+
+    {
+      std::lock_guard<std::mutex> lk (save_m);
+      if (save_cancel) {
+        save_status = ustring::compose ("Cancelled saving attachments, saved %1 of %2.", saved.load (), attachments.size ());
+      } else {
+        save_status = ustring::compose ("Saved %1 of %2 attachments to %3 (%4).", saved.load (), attachments.size (), dir, Utils::format_size (total.load ()));
+      }
+    }
+
+    saving = false;
+    save_progress.emit ();
+  }
+
+  void ThreadView::on_save_progress () {
+    if (!save_message) return;
+
+    std::lock_guard<std::mutex> lk (save_m);
+
+    if (!saving && (save_failed || save_cancel)) {
+      set_warning (save_message, save_status + (save_failed ? " Some attachments could not be saved, see the log." : ""));
+    } else {
+      set_info (save_message, save_status);
+    }
+
+    if (!saving) save_message.reset ();
+  }
+
   /* general mode stuff  */
   void ThreadView::grab_focus () {
     //LOG (debug) << "tv: grab focus";
@@ -2158,14 +2503,17 @@ namespace Astroid {
   void ThreadView::reset_search () {
     /* reset */
     if (in_search) {
-      /* reset search expanded state */
+      /* close the messages that were opened by the search, except the
+       * focused one */
       for (auto m : mthread->messages) {
+        if (state[m].search_expanded && m != focused_message) collapse (m);
         state[m].search_expanded = false;
       }
     }
 
     in_search = false;
     search_q  = "";
+    searcher.clear ();
 
     WebKitFindController * f = webkit_web_view_get_find_controller (webview);
     webkit_find_controller_search_finish (f);
@@ -2174,42 +2522,77 @@ namespace Astroid {
   void ThreadView::on_search (ustring k) {
     if (!k.empty ()) {
 
-      /* expand all messages, these should be closed - except the focused one
-       * when a search is cancelled */
+      LOG (debug) << "tv: searching for: " << k;
+      search_q = k;
+
+      if (searcher.search (mthread, k) == 0) {
+        LOG (info) << "tv: search: no matches for: " << k;
+        reset_search ();
+        return;
+      }
+
+      /* only expand the messages with matches, these should be closed -
+       * except the focused one when a search is cancelled. matches behind
+       * placeholders are loaded when they are focused. */
       for (auto m : mthread->messages) {
-        state[m].search_expanded = !expand (m);
+        if (state[m].loaded && searcher.has_match (m)) {
+          state[m].search_expanded = !expand (m);
+        }
       }
 
-      LOG (debug) << "tv: searching for: " << k;
+      /* the find controller is only used to highlight the matches in
+       * the expanded messages, navigation is driven by the match list. */
       WebKitFindController * f = webkit_web_view_get_find_controller (webview);
 
       webkit_find_controller_search (f, k.c_str (),
           WEBKIT_FIND_OPTIONS_CASE_INSENSITIVE |
           WEBKIT_FIND_OPTIONS_WRAP_AROUND,
-          0);
+          G_MAXUINT);
       in_search = true;
-      page_client->update_focus_to_view ();
+
+      searcher.seek (mthread, focused_message);
+      focus_search_match (searcher.current ());
     }
   }
 
+  void ThreadView::focus_search_match (const ThreadSearch::Match * mt) {
+    if (mt == NULL) return;
+
+    refptr<Message> m = mt->message;
+
+    if (!state[m].expanded) {
+      state[m].search_expanded = !expand (m);
+    }
+
+    /* header matches and matches in parts that are shown inline (and
+     * can not be focused) focus the message itself */
+    unsigned int e = 0;
+    if (mt->chunk >= 0) {
+      auto &els = state[m].elements;
+      auto it = std::find_if (els.begin (), els.end (),
+          [&] (auto &el) {
+            return el.type == MessageState::ElementType::Part
+              && el.id == mt->chunk
+              && el.focusable;
+          });
+
+      if (it != els.end ()) e = std::distance (els.begin (), it);
+    }
+
+    LOG (debug) << "tv: search: focusing match in: " << m->safe_mid () << ", element: " << e;
+    focus_element (m, e);
+  }
+
   void ThreadView::next_search_match () {
     if (!in_search) return;
-    /* there does not seem to be a way to figure out which message currently
-     * contains the selected matched text, but when there is a scroll event
-     * the match is centered.
-     */
 
-    WebKitFindController * f = webkit_web_view_get_find_controller (webview);
-    webkit_find_controller_search_next (f);
-    page_client->update_focus_to_view ();
+    focus_search_match (searcher.next ());
   }
 
   void ThreadView::prev_search_match () {
     if (!in_search) return;
 
-    WebKitFindController * f = webkit_web_view_get_find_controller (webview);
-    webkit_find_controller_search_previous (f);
-    page_client->update_focus_to_view ();
+    focus_search_match (searcher.previous ());
   }
 
   /***************
@@ -8,6 +8,7 @@
 # include <mutex>
 # include <condition_variable>
 # include <functional>
+# include <thread>
 
 # include <gtkmm.h>
 # include <webkit2/webkit2.h>
@@ -18,6 +19,7 @@
 # include "modes/mode.hh"
 # include "message_thread.hh"
 # include "theme.hh"
+# include "thread_search.hh"
 # ifndef DISABLE_PLUGINS
   # include "plugin/manager.hh"
 # endif
@@ -76,6 +78,9 @@ namespace Astroid {
 
       void pre_close () override;
 
+      /* web process started and page loaded */
+      bool is_loaded ();
+
       /* Web extension */
       PageClient * page_client;
 
@@ -108,6 +113,11 @@ namespace Astroid {
           bool marked           = false;
           bool unread_checked   = false;
 
+          /* messages in large threads may be hidden behind a placeholder,
+           * keyed by the first message it stands for */
+          bool loaded           = true;
+          refptr<Message> placeholder;
+
           enum ElementType {
             Empty = 0,
             Address,
@@ -178,12 +188,52 @@ namespace Astroid {
 
       /* message loading and rendering */
       void add_message (refptr<Message>);
+      void render_message (refptr<Message>, refptr<Message> before = refptr<Message> ());
+
+      /* large threads: only the messages around the focused one are
+       * rendered, runs of the others are shown as placeholders */
+      unsigned int window_threshold;
+      unsigned int window_size;
+
+      struct Placeholder {
+        std::vector<refptr<Message>> messages;
+        refptr<Message> before; // next message on the page, if any
+      };
+
+      std::map<refptr<Message>, Placeholder> placeholders;
+
+      void window_messages ();
+      void load_placeholder (refptr<Message>);
+      ustring placeholder_summary (Placeholder &);
 
       bool open_html_part_external;
 
       void update_all_indent_states ();
 
       void save_all_attachments ();
+
+      /* attachments are saved on a worker thread */
+      std::thread        save_thread;
+      std::atomic<bool>  saving;
+      std::atomic<bool>  save_cancel;
+      std::mutex         save_m;
+      ustring            save_status;
+      bool               save_failed;
+      refptr<Message>    save_message;
+      Glib::Dispatcher   save_progress;
+
+      /* prepared on the gui thread, the worker only reads from its own
+       * streams */
+      struct SaveJob {
+        std::string           to;
+        GMimeStream *         stream;
+        GMimeContentEncoding  encoding;
+      };
+
+      static const unsigned int SAVE_THREADS = 4;
+      void save_attachments_worker (std::vector<SaveJob>, std::string dir);
+      void on_save_progress ();
+
     public:
 
       /* event wrappers */
@@ -220,9 +270,11 @@ namespace Astroid {
 
       void next_search_match ();
       void prev_search_match ();
+      void focus_search_match (const ThreadSearch::Match *);
 
       bool in_search = false;
       ustring search_q = "";
+      ThreadSearch searcher;
 
     public:
       /* the tv is ready */
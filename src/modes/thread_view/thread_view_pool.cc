@@ -0,0 +1,77 @@
+# include <boost/property_tree/ptree.hpp>
+
+# include "astroid.hh"
+# include "thread_view_pool.hh"
+# include "thread_view.hh"
+
+using std::string;
+
+namespace Astroid {
+  std::deque<ThreadView *> ThreadViewPool::pool;
+  bool ThreadViewPool::filling = false;
+  bool ThreadViewPool::closed  = false;
+
+  ThreadView * ThreadViewPool::take (MainWindow * mw) {
+    ThreadView * tv = NULL;
+
+    /* prefer one that is ready, otherwise the oldest will be ready first */
+    for (auto it = pool.begin (); it != pool.end (); it++) {
+      if ((*it)->is_loaded ()) {
+        tv = *it;
+        pool.erase (it);
+        break;
+      }
+    }
+
+    if (tv == NULL && !pool.empty ()) {
+      tv = pool.front ();
+      pool.pop_front ();
+    }
+
+    if (tv) {
+      LOG (debug) << "tvp: using pooled thread view (" << pool.size () << " left).";
+      tv->set_main_window (mw);
+      Gtk::manage (tv);
+    } else {
+      tv = Gtk::manage (new ThreadView (mw));
+    }
+
+    fill ();
+
+    return tv;
+  }
+
+  void ThreadViewPool::fill () {
+    if (filling || closed) return;
+
+    filling = true;
+    Glib::signal_idle ().connect (&ThreadViewPool::on_fill, Glib::PRIORITY_LOW);
+  }
+
+  bool ThreadViewPool::on_fill () {
+    unsigned int size = astroid->config ("thread_view").get<unsigned int> ("preload_views");
+
+    if (closed || pool.size () >= size) {
+      filling = false;
+      return false;
+    }
+
+    LOG (debug) << "tvp: preparing thread view..";
+    pool.push_back (new ThreadView (NULL));
+
+    /* one per idle iteration so that the gui stays responsive */
+    return true;
+  }
+
+  void ThreadViewPool::clear () {
+    closed = true;
+
+    for (auto tv : pool) {
+      tv->pre_close ();
+      delete tv;
+    }
+
+    pool.clear ();
+  }
+}
+
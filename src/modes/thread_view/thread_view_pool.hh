@@ -0,0 +1,30 @@
+# pragma once
+
+# include <deque>
+
+# include "proto.hh"
+
+namespace Astroid {
+  /* keeps a few thread views with the web process started, the extension
+   * connected and the page loaded, so that opening a thread does not have
+   * to wait for them. */
+  class ThreadViewPool {
+    public:
+      /* get a ready thread view for main window, or a new one if none
+       * are ready. the pool is replenished in the background. */
+      static ThreadView * take (MainWindow *);
+
+      /* start filling the pool when idle */
+      static void fill ();
+
+      static void clear ();
+
+    private:
+      static std::deque<ThreadView *> pool;
+      static bool filling;
+      static bool closed;
+
+      static bool on_fill ();
+  };
+}
+
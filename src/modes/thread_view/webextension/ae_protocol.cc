@@ -5,6 +5,7 @@
 # include <string>
 # include <mutex>
 # include <iostream>
+# include <sstream>
 
 #ifdef ASTROID_WEBEXTENSION
 
@@ -37,8 +38,13 @@ namespace Astroid {
     "AddMessage",
     "UpdateMessage",
     "RemoveMessage",
+    "Placeholder",
   };
 
+#ifndef ASTROID_WEBEXTENSION
+  AeProtocol::Stats AeProtocol::stats[AeProtocol::MessageTypeCount];
+#endif
+
 
   void AeProtocol::send_message (
       MessageTypes mt,
@@ -49,7 +55,13 @@ namespace Astroid {
     gsize written = 0;
     bool  s = false;
 
+#ifndef ASTROID_WEBEXTENSION
+    gint64 t0 = g_get_monotonic_time ();
+    m.SerializeToString (&o);
+    stats[mt].add_sent (o.size (), g_get_monotonic_time () - t0);
+#else
     m.SerializeToString (&o);
+#endif
 
     /* send size of message */
     gsize sz = o.size ();
@@ -83,7 +95,13 @@ namespace Astroid {
   {
     LOG (debug) << "ae: sending: " << MessageTypeStrings[mt];
     LOG (debug) << "ae: send (async) waiting for lock";
+#ifndef ASTROID_WEBEXTENSION
+    gint64 t0 = g_get_monotonic_time ();
+    std::lock_guard<std::mutex> lk (m_ostream);
+    stats[mt].add_lock_wait (g_get_monotonic_time () - t0);
+#else
     std::lock_guard<std::mutex> lk (m_ostream);
+#endif
     send_message (mt, m, ostream);
     LOG (debug) << "ae: send (async) message sent.";
   }
@@ -96,10 +114,19 @@ namespace Astroid {
       Glib::RefPtr<Gio::InputStream> istream,
       std::mutex & m_istream)
   {
+    const MessageTypes smt = mt;
+
     LOG (debug) << "ae: sending: " << MessageTypeStrings[mt];
     LOG (debug) << "ae: send (sync) waiting for lock..";
+#ifndef ASTROID_WEBEXTENSION
+    gint64 t0 = g_get_monotonic_time ();
+#endif
     std::lock_guard<std::mutex> rlk (m_istream);
     std::lock_guard<std::mutex> wlk (m_ostream);
+    gint64 t1 = g_get_monotonic_time ();
+#ifndef ASTROID_WEBEXTENSION
+    stats[mt].add_lock_wait (t1 - t0);
+#endif
     LOG (debug) << "ae: send (sync) lock acquired.";
 
     /* send message */
@@ -124,6 +151,15 @@ namespace Astroid {
         return a;
       }
 
+      gint64 rt = g_get_monotonic_time () - t1;
+#ifndef ASTROID_WEBEXTENSION
+      stats[smt].add_roundtrip (rt);
+#endif
+
+      if (rt >= SLOW_ROUNDTRIP_US) {
+        LOG (warn) << "ae: slow round trip: " << MessageTypeStrings[smt] << " took: " << (rt / 1000) << " ms.";
+      }
+
       LOG (debug) << "ae: send (sync) ACK received.";
       a.ParseFromArray (msg_str.data(), msg_str.size());
     }
@@ -158,6 +194,10 @@ namespace Astroid {
       throw ipc_error ("could not read message type");
     }
 
+    if ((unsigned int) mt >= MessageTypeCount) {
+      throw ipc_error ("unknown message type");
+    }
+
     /* read message */
     buffer.resize (msg_sz);
     try {
@@ -171,9 +211,127 @@ namespace Astroid {
       LOG (error) << "reader: error while reading message (size: " << msg_sz << ")";
       throw ipc_error ("could not read message");
     }
+
+#ifndef ASTROID_WEBEXTENSION
+    stats[mt].add_received (msg_sz);
+#endif
+
     return mt;
   }
 
+#ifndef ASTROID_WEBEXTENSION
+  /***************
+   * Statistics
+   *
+   * only kept by astroid, there is nothing in the extension that
+   * would report them.
+   ***************/
+
+  static int bucket (unsigned long v, unsigned long first, int buckets) {
+    int b = 0;
+    for (unsigned long l = first; b < (buckets - 1) && v >= l; l *= 10) b++;
+    return b;
+  }
+
+  static void set_max (std::atomic<unsigned long> &m, unsigned long v) {
+    unsigned long c = m;
+    while (v > c && !m.compare_exchange_weak (c, v));
+  }
+
+  void AeProtocol::Stats::add_sent (gsize bytes, gint64 serialize) {
+    sent++;
+    sent_bytes   += bytes;
+    serialize_us += serialize;
+    set_max (max_bytes, bytes);
+    size_histogram[bucket (bytes, 1000, BUCKETS)]++;
+  }
+
+  void AeProtocol::Stats::add_lock_wait (gint64 us) {
+    lock_wait_us += us;
+    set_max (max_lock_wait_us, us);
+    lock_wait_histogram[bucket (us, 100, BUCKETS)]++;
+  }
+
+  void AeProtocol::Stats::add_roundtrip (gint64 us) {
+    roundtrips++;
+    roundtrip_us += us;
+    set_max (max_roundtrip_us, us);
+    roundtrip_histogram[bucket (us, 100, BUCKETS)]++;
+  }
+
+  void AeProtocol::Stats::add_received (gsize bytes) {
+    received++;
+    received_bytes += bytes;
+  }
+
+  void AeProtocol::Stats::reset () {
+    sent = sent_bytes = max_bytes = serialize_us = 0;
+    lock_wait_us = max_lock_wait_us = 0;
+    roundtrips = roundtrip_us = max_roundtrip_us = 0;
+    received = received_bytes = 0;
+
+    for (int b = 0; b < BUCKETS; b++) {
+      size_histogram[b] = lock_wait_histogram[b] = roundtrip_histogram[b] = 0;
+    }
+  }
+
+  void AeProtocol::reset_stats () {
+    for (auto &s : stats) s.reset ();
+  }
+
+  void AeProtocol::log_stats () {
+    auto hist = [] (std::atomic<unsigned long> * h) {
+      std::ostringstream o;
+      for (int b = 0; b < Stats::BUCKETS; b++) {
+        o << (b > 0 ? "/" : "") << h[b].load ();
+      }
+      return o.str ();
+    };
+
+    LOG (info) << "ae: ipc statistics (latency buckets: <100us/<1ms/<10ms/<100ms/>=100ms, size buckets: <1kB/<10kB/<100kB/<1MB/>=1MB):";
+
+    bool any = false;
+
+    for (int t = 0; t < MessageTypeCount; t++) {
+      Stats &s = stats[t];
+
+      unsigned long sent       = s.sent;
+      unsigned long received   = s.received;
+      unsigned long roundtrips = s.roundtrips;
+
+      if (sent == 0 && received == 0) continue;
+      any = true;
+
+      std::ostringstream o;
+      o << "ae: " << MessageTypeStrings[t] << ": sent: " << sent;
+
+      if (sent > 0) {
+        o << ", bytes: " << s.sent_bytes
+          << " (mean: " << (s.sent_bytes / sent) << ", max: " << s.max_bytes << ")"
+          << ", sizes: " << hist (s.size_histogram)
+          << ", serialize: " << (s.serialize_us / sent) << " us"
+          << ", lock wait: " << (s.lock_wait_us / sent) << " us"
+          << " (max: " << s.max_lock_wait_us << " us, " << hist (s.lock_wait_histogram) << ")";
+      }
+
+      if (roundtrips > 0) {
+        o << ", round trip: " << (s.roundtrip_us / roundtrips) << " us"
+          << " (max: " << s.max_roundtrip_us << " us, " << hist (s.roundtrip_histogram) << ")";
+      }
+
+      if (received > 0) {
+        o << ", received: " << received << " (" << s.received_bytes << " bytes)";
+      }
+
+      LOG (info) << o.str ();
+    }
+
+    if (!any) {
+      LOG (info) << "ae: no messages exchanged.";
+    }
+  }
+#endif
+
 
   /***************
    * Exceptions
@@ -2,6 +2,7 @@
 
 # include <giomm.h>
 # include <mutex>
+# include <atomic>
 
 # include "messages.pb.h"
 
@@ -28,6 +29,9 @@ namespace Astroid {
         AddMessage,
         UpdateMessage,
         RemoveMessage,
+        Placeholder,
+
+        MessageTypeCount, /* not a message */
       } MessageTypes;
 
       static const char* MessageTypeStrings[];
@@ -52,6 +56,45 @@ namespace Astroid {
           Glib::RefPtr<Gio::Cancellable> reader_cancel,
           std::vector<gchar> &buffer);
 
+#ifndef ASTROID_WEBEXTENSION
+      /* statistics per message type, for the messages astroid sends to
+       * and receives from the extension */
+      struct Stats {
+        /* decade buckets: latency from < 100us to >= 100ms, size from
+         * < 1kB to >= 1MB */
+        static const int BUCKETS = 5;
+
+        std::atomic<unsigned long> sent          {0};
+        std::atomic<unsigned long> sent_bytes    {0};
+        std::atomic<unsigned long> max_bytes     {0};
+        std::atomic<unsigned long> serialize_us  {0};
+        std::atomic<unsigned long> lock_wait_us  {0};
+        std::atomic<unsigned long> max_lock_wait_us {0};
+        std::atomic<unsigned long> roundtrips    {0};
+        std::atomic<unsigned long> roundtrip_us  {0};
+        std::atomic<unsigned long> max_roundtrip_us {0};
+        std::atomic<unsigned long> received      {0};
+        std::atomic<unsigned long> received_bytes {0};
+
+        std::atomic<unsigned long> size_histogram[BUCKETS]      = {};
+        std::atomic<unsigned long> lock_wait_histogram[BUCKETS] = {};
+        std::atomic<unsigned long> roundtrip_histogram[BUCKETS] = {};
+
+        void add_sent (gsize bytes, gint64 serialize);
+        void add_lock_wait (gint64 us);
+        void add_roundtrip (gint64 us);
+        void add_received (gsize bytes);
+        void reset ();
+      };
+
+      static Stats stats[MessageTypeCount];
+
+      /* write the statistics of all message types that have been used to
+       * the log */
+      static void log_stats ();
+      static void reset_stats ();
+#endif
+
       /* exceptions */
       class ipc_error : public std::runtime_error {
         public:
@@ -59,6 +102,8 @@ namespace Astroid {
       };
 
     private:
+      static const gint64 SLOW_ROUNDTRIP_US = 100000;
+
       static void send_message (
           MessageTypes mt,
           const ::google::protobuf::Message &m,
@@ -65,6 +65,13 @@ bool web_page_send_request ( WebKitWebPage    *  web_page,
   return ext->send_request (web_page, request, response, user_data);
 }
 
+void web_page_scrolled ( WebKitDOMEventTarget * /* target */,
+                         WebKitDOMEvent *       /* event */,
+                         gpointer               /* user_data */)
+{
+  ext->check_pending_bodies ();
+}
+
 G_MODULE_EXPORT void
 webkit_web_extension_initialize_with_user_data (
     WebKitWebExtension *extension,
@@ -368,6 +375,16 @@ void AstroidExtension::reader () {/*{{{*/
         }
         break;
 
+      case AeProtocol::MessageTypes::Placeholder:
+        {
+          AstroidMessages::Placeholder m;
+          m.ParseFromArray (buffer.data(), buffer.size());
+          Glib::signal_idle().connect_once (
+              sigc::bind (
+                sigc::mem_fun(*this, &AstroidExtension::add_placeholder), m));
+        }
+        break;
+
       case AeProtocol::MessageTypes::UpdateMessage:
         {
           AstroidMessages::UpdateMessage m;
@@ -472,6 +489,14 @@ void AstroidExtension::handle_page (AstroidMessages::Page &s) {/*{{{*/
     allowed_uris.push_back (s);
   }
 
+  /* load bodies as they are scrolled into view */
+  WebKitDOMDOMWindow * w = webkit_dom_document_get_default_view (d);
+  webkit_dom_event_target_add_event_listener (WEBKIT_DOM_EVENT_TARGET (w),
+      "scroll", G_CALLBACK (web_page_scrolled), false, NULL);
+  webkit_dom_event_target_add_event_listener (WEBKIT_DOM_EVENT_TARGET (w),
+      "resize", G_CALLBACK (web_page_scrolled), false, NULL);
+  g_object_unref (w);
+
   page_ready = true;
 
   g_object_unref (he);
@@ -496,6 +521,13 @@ void AstroidExtension::reload_images () {
       if (!c.focusable ()) {
         WebKitDOMElement * body_container = webkit_dom_document_get_element_by_id (d, c.sid ().c_str ());
         WebKitDOMHTMLElement * iframe = DomUtils::select (WEBKIT_DOM_NODE(body_container), ".body_iframe");
+
+        if (iframe == NULL) {
+          /* not loaded yet */
+          g_object_unref (body_container);
+          continue;
+        }
+
         WebKitDOMDocument * iframe_d = webkit_dom_html_iframe_element_get_content_document (WEBKIT_DOM_HTML_IFRAME_ELEMENT(iframe));
         WebKitDOMHTMLElement * b = webkit_dom_document_get_body (iframe_d);
 
@@ -558,6 +590,10 @@ void AstroidExtension::handle_state (AstroidMessages::State &s) {/*{{{*/
   LOG (debug) << "got state.";
   state = s;
   edit_mode = state.edit_mode ();
+
+  /* all messages have been added and hidden or shown */
+  check_pending_bodies ();
+
   ack (true);
 }/*}}}*/
 
@@ -605,6 +641,7 @@ void AstroidExtension::clear_messages (AstroidMessages::ClearMessage &) {
   focused_message = "";
   focused_element = -1;
   messages.clear ();
+  pending_bodies.clear ();
   state = AstroidMessages::State();
   allow_remote_resources = false;
   indent_messages = false;
@@ -622,8 +659,7 @@ void AstroidExtension::add_message (AstroidMessages::Message &m) {
 
   ustring div_id = "message_" + m.mid();
 
-  WebKitDOMNode * insert_before = webkit_dom_node_get_last_child (
-      WEBKIT_DOM_NODE(container));
+  WebKitDOMNode * insert_before = get_insert_point (d, container, m.insert_before ());
 
   WebKitDOMHTMLElement * div_message = DomUtils::make_message_div (d);
 
@@ -664,9 +700,67 @@ void AstroidExtension::add_message (AstroidMessages::Message &m) {
   ack (true);
 }
 
+WebKitDOMNode * AstroidExtension::get_insert_point (
+    WebKitDOMDocument * d,
+    WebKitDOMElement * container,
+    ustring before)
+{
+  /* messages loaded from a placeholder go in the middle of the thread,
+   * everything else at the end */
+  if (!before.empty ()) {
+    ustring before_id = "message_" + before;
+    WebKitDOMElement * e = webkit_dom_document_get_element_by_id (d, before_id.c_str ());
+
+    if (e != NULL) return WEBKIT_DOM_NODE (e);
+
+    LOG (warn) << "could not find message to insert before: " << before;
+  }
+
+  return webkit_dom_node_get_last_child (WEBKIT_DOM_NODE(container));
+}
+
+void AstroidExtension::add_placeholder (AstroidMessages::Placeholder &p) {
+  /* the placeholder takes the place of its first message, it is removed
+   * like a message when its messages are loaded */
+  LOG (debug) << "adding placeholder: " << p.mid () << " (" << p.count () << " messages)";
+
+  WebKitDOMDocument *d = webkit_web_page_get_dom_document (page);
+  WebKitDOMElement * container = DomUtils::get_by_id (d, "message_container");
+
+  ustring div_id = "message_" + p.mid();
+
+  WebKitDOMNode * insert_before = get_insert_point (d, container, p.insert_before ());
+
+  GError * err = NULL;
+
+  WebKitDOMElement * div = webkit_dom_document_create_element (d, "div", (err = NULL, &err));
+  webkit_dom_element_set_id (div, div_id.c_str ());
+  webkit_dom_element_set_class_name (div, "email placeholder hide");
+
+  WebKitDOMElement * summary = webkit_dom_document_create_element (d, "div", (err = NULL, &err));
+  webkit_dom_element_set_class_name (summary, "email_container placeholder_summary");
+  webkit_dom_node_set_text_content (WEBKIT_DOM_NODE (summary), p.summary ().c_str (), (err = NULL, &err));
+
+  webkit_dom_node_append_child (WEBKIT_DOM_NODE (div), WEBKIT_DOM_NODE (summary), (err = NULL, &err));
+
+  webkit_dom_node_insert_before (WEBKIT_DOM_NODE(container),
+      WEBKIT_DOM_NODE(div),
+      insert_before,
+      (err = NULL, &err));
+
+  g_object_unref (summary);
+  g_object_unref (div);
+  g_object_unref (insert_before);
+  g_object_unref (container);
+  g_object_unref (d);
+
+  ack (true);
+}
+
 void AstroidExtension::remove_message (AstroidMessages::Message &m) {
   LOG (debug) << "removing message: " << m.mid ();
   messages.erase (m.mid());
+  drop_pending_bodies (m.mid ());
 
   WebKitDOMDocument *d = webkit_web_page_get_dom_document (page);
   WebKitDOMElement * container = DomUtils::get_by_id (d, "message_container");
@@ -771,6 +865,7 @@ void AstroidExtension::update_message (AstroidMessages::UpdateMessage &um) {
     }
 
     apply_focus (focused_message, focused_element);
+    check_pending_bodies ();
 
   } else if (um.type () == AstroidMessages::UpdateMessage_Type_Tags) {
     LOG (debug) << "updating message: " << m.mid () << " (tags only)";
@@ -1014,8 +1109,10 @@ void AstroidExtension::create_body_part (
   GError *err;
 
   WebKitDOMDocument * d = webkit_web_page_get_dom_document (page);
+
+  /* the iframe is only added when the body is loaded */
   WebKitDOMHTMLElement * body_container =
-    DomUtils::clone_select (WEBKIT_DOM_NODE(d), "#body_template");
+    DomUtils::clone_select (WEBKIT_DOM_NODE(d), "#body_template", false);
 
   webkit_dom_element_remove_attribute (WEBKIT_DOM_ELEMENT (body_container),
       "id");
@@ -1140,12 +1237,12 @@ void AstroidExtension::create_body_part (
   g_object_unref (d);
 
   /*
-   * run this later on extension GUI thread in order to make sure that the "body part" has been
-   * added to the document.
+   * the iframe is created and filled in later on the extension GUI thread,
+   * when the "body part" has been added to the document and the message has
+   * been expanded and is in view. new messages are checked when the state is
+   * received, at that point it is known which ones are collapsed.
    */
-  Glib::signal_idle().connect_once (
-      sigc::bind (
-        sigc::mem_fun(*this, &AstroidExtension::set_iframe_src), message.mid(), c.sid(), body));
+  pending_bodies[c.sid ()] = { message.mid (), body };
 
   LOG (debug) << "create_body_part done.";
 }
@@ -1158,9 +1255,21 @@ void AstroidExtension::set_iframe_src (ustring mid, ustring cid, ustring body) {
 
   WebKitDOMElement * body_container = webkit_dom_document_get_element_by_id (d, cid.c_str ());
 
+  if (body_container == NULL) {
+    LOG (warn) << "set iframe src: part has been removed: " << cid;
+    g_object_unref (d);
+    return;
+  }
+
   WebKitDOMHTMLElement * iframe =
     DomUtils::select (WEBKIT_DOM_NODE(body_container), ".body_iframe");
 
+  if (iframe == NULL) {
+    iframe = DomUtils::clone_select (WEBKIT_DOM_NODE(d), "#body_template .body_iframe");
+
+    webkit_dom_node_append_child (WEBKIT_DOM_NODE (body_container),
+        WEBKIT_DOM_NODE (iframe), (err = NULL, &err));
+  }
 
   /* by using srcdoc we avoid creating any requests that would have to be
    * allowed on the main GUI thread. even if we run this function async there
@@ -1187,6 +1296,78 @@ void AstroidExtension::set_iframe_src (ustring mid, ustring cid, ustring body) {
   g_object_unref (d);
 }
 
+void AstroidExtension::check_pending_bodies () {
+  if (pending_check || pending_bodies.empty ()) return;
+
+  /* coalesce scroll events and part creation */
+  pending_check = true;
+  Glib::signal_idle().connect_once (
+      sigc::mem_fun (*this, &AstroidExtension::load_pending_bodies));
+}
+
+void AstroidExtension::load_pending_bodies () {
+  pending_check = false;
+
+  WebKitDOMDocument * d = webkit_web_page_get_dom_document (page);
+  WebKitDOMDOMWindow * w = webkit_dom_document_get_default_view (d);
+  WebKitDOMElement * body = WEBKIT_DOM_ELEMENT(webkit_dom_document_get_body (d));
+
+  double scrolled = webkit_dom_dom_window_get_scroll_y (w);
+  double height   = webkit_dom_element_get_client_height (body);
+
+  std::map<ustring, bool> near_view; // by mid
+
+  for (auto it = pending_bodies.begin (); it != pending_bodies.end (); ) {
+    ustring mid = it->second.mid;
+
+    auto nv = near_view.find (mid);
+    if (nv == near_view.end ()) {
+      ustring div_id = "message_" + mid;
+      WebKitDOMElement * e = webkit_dom_document_get_element_by_id (d, div_id.c_str());
+
+      bool near = false;
+
+      if (e != NULL) {
+        WebKitDOMDOMTokenList * class_list = webkit_dom_element_get_class_list (e);
+
+        if (!webkit_dom_dom_token_list_contains (class_list, "hide")) {
+          double clientY = webkit_dom_element_get_offset_top (e);
+          double clientH = webkit_dom_element_get_client_height (e);
+
+          near = (height == 0) ||
+            ((clientY <= (scrolled + height + LOAD_MARGIN)) &&
+             ((clientY + clientH) >= (scrolled - LOAD_MARGIN)));
+        }
+
+        g_object_unref (class_list);
+        g_object_unref (e);
+      }
+
+      nv = near_view.insert (std::make_pair (mid, near)).first;
+    }
+
+    if (nv->second) {
+      set_iframe_src (mid, it->first, it->second.body);
+      it = pending_bodies.erase (it);
+    } else {
+      it++;
+    }
+  }
+
+  LOG (debug) << "bodies pending: " << pending_bodies.size ();
+
+  g_object_unref (body);
+  g_object_unref (w);
+  g_object_unref (d);
+}
+
+void AstroidExtension::drop_pending_bodies (ustring mid) {
+  for (auto it = pending_bodies.begin (); it != pending_bodies.end (); ) {
+    if (it->second.mid == mid) it = pending_bodies.erase (it);
+    else it++;
+  }
+}
+
 void AstroidExtension::create_sibling_part (
     /* const AstroidMessages::Message &message, */
     const AstroidMessages::Message::Chunk &sibling,
@@ -1757,6 +1938,7 @@ void AstroidExtension::set_hidden (ustring mid, bool hidden) {
   } else if (webkit_dom_dom_token_list_contains (class_list, "hide")) {
     LOG (debug) << "show: " << mid;
     webkit_dom_dom_token_list_toggle (class_list, "hide", false, &err );
+    check_pending_bodies ();
   }
 
   /* if the message we just hid or showed is not the focused one it may have
@@ -32,6 +32,10 @@ bool web_page_send_request ( WebKitWebPage    *  web_page,
                              WebKitURIResponse * response,
                              gpointer            user_data);
 
+void web_page_scrolled ( WebKitDOMEventTarget * target,
+                         WebKitDOMEvent *       event,
+                         gpointer               user_data);
+
 }
 
 class AstroidExtension {
@@ -108,6 +112,8 @@ class AstroidExtension {
     void set_hidden (ustring, bool);
 
     void add_message (AstroidMessages::Message &m);
+    void add_placeholder (AstroidMessages::Placeholder &p);
+    WebKitDOMNode * get_insert_point (WebKitDOMDocument *, WebKitDOMElement * container, ustring before);
     void remove_message (AstroidMessages::Message &m);
     void update_message (AstroidMessages::UpdateMessage &m);
 
@@ -126,6 +132,24 @@ class AstroidExtension {
 
     void set_iframe_src (ustring, ustring, ustring);
 
+    /* body parts are only loaded into their iframe when the message is
+     * expanded and close to the view */
+    struct PendingBody {
+      ustring mid;
+      ustring body;
+    };
+
+    std::map<ustring, PendingBody> pending_bodies; // by part sid
+    bool pending_check = false;
+    const int LOAD_MARGIN = 1000; // px outside view to load bodies in advance
+
+  public:
+    void check_pending_bodies ();
+
+  private:
+    void load_pending_bodies ();
+    void drop_pending_bodies (ustring mid);
+
     void create_sibling_part (
         /* const AstroidMessages::Message &message, */
         const AstroidMessages::Message::Chunk &c,
@@ -2,6 +2,7 @@
 # include <glibmm.h>
 # include <vector>
 # include <cstdlib>
+# include <chrono>
 
 # include <boost/filesystem.hpp>
 
@@ -25,12 +26,21 @@ namespace bfs = boost::filesystem;
 /* remember to set GI_TYPELIB_PATH=$(pwd) when testing */
 
 namespace Astroid {
+  const char * const PluginManager::hook_names[HookCount] = {
+    "format_tags",
+    "get_tag_colors",
+    "get_avatar_uri",
+    "filter_part",
+    "process",
+  };
+
   PluginManager::PluginManager (bool _disabled, bool _test) {
     LOG (info) << "plugins: starting manager..";
 
 
     disabled = _disabled;
     test     = _test;
+    memoize  = astroid->config ().get<bool> ("astroid.plugins.cache_pure_hooks");
 
     if (disabled) {
       LOG (info) << "plugins: disabled.";
@@ -77,6 +87,7 @@ namespace Astroid {
     if (disabled) return;
 
     LOG (debug) << "plugins: refreshing..";
+    cache_clear ();
     peas_engine_rescan_plugins (engine);
 
     const GList * ps = peas_engine_get_plugin_list (engine);
@@ -129,6 +140,88 @@ namespace Astroid {
     }
   }
 
+  /* ********************
+   * Hook statistics
+   * ********************/
+  void PluginManager::HookStats::add (unsigned long us) {
+    calls++;
+    total_us += us;
+
+    unsigned long m = max_us;
+    while (us > m && !max_us.compare_exchange_weak (m, us));
+
+    int b = 0;
+    for (unsigned long l = 10; b < (BUCKETS - 1) && us >= l; l *= 10) b++;
+    histogram[b]++;
+  }
+
+  PluginManager::HookTimer::HookTimer (Hook h) : hook (h) {
+    t0 = std::chrono::steady_clock::now ();
+  }
+
+  PluginManager::HookTimer::~HookTimer () {
+    unsigned long us = std::chrono::duration_cast<std::chrono::microseconds> (
+        std::chrono::steady_clock::now () - t0).count ();
+
+    astroid->plugin_manager->hook_stats[hook].add (us);
+
+    if (us >= SLOW_HOOK_US) {
+      LOG (warn) << "plugins: slow hook: " << hook_names[hook] << " took: " << (us / 1000) << " ms.";
+    }
+  }
+
+  void PluginManager::log_hook_stats () {
+    LOG (info) << "plugins: hook statistics (latency buckets: <10us/<100us/<1ms/<10ms/<100ms/>=100ms):";
+
+    for (int h = 0; h < HookCount; h++) {
+      HookStats &s = hook_stats[h];
+
+      unsigned long calls = s.calls;
+      unsigned long mean  = calls > 0 ? (s.total_us / calls) : 0;
+
+      ustring hist;
+      for (int b = 0; b < HookStats::BUCKETS; b++) {
+        hist += ustring::compose ("%1%2", (b > 0 ? "/" : ""), s.histogram[b].load ());
+      }
+
+      LOG (info) << "plugins: " << hook_names[h] << ": calls: " << calls
+                 << ", cache hits: " << s.cache_hits
+                 << ", mean: " << mean << " us"
+                 << ", max: " << s.max_us << " us"
+                 << ", histogram: " << hist;
+    }
+  }
+
+  bool PluginManager::cache_lookup (Hook h, const std::string & key, CachedResult & out) {
+    if (!memoize) return false;
+
+    std::lock_guard<std::mutex> lk (hook_cache_m);
+    auto r = hook_cache[h].find (key);
+
+    if (r == hook_cache[h].end ()) return false;
+
+    out = r->second;
+    hook_stats[h].cache_hits++;
+    return true;
+  }
+
+  void PluginManager::cache_store (Hook h, const std::string & key, CachedResult r) {
+    if (!memoize) return;
+
+    std::lock_guard<std::mutex> lk (hook_cache_m);
+
+    /* bounded: start over rather than tracking usage */
+    if (hook_cache[h].size () >= MAX_CACHED) hook_cache[h].clear ();
+
+    hook_cache[h][key] = r;
+  }
+
+  void PluginManager::cache_clear () {
+    std::lock_guard<std::mutex> lk (hook_cache_m);
+
+    for (auto &c : hook_cache) c.clear ();
+  }
+
   /* ********************
    * Extension
    * ********************/
@@ -220,10 +313,24 @@ namespace Astroid {
 
     if (!active || astroid->plugin_manager->disabled) return clrs;
 
+    /* keys are only built when results are memoized */
+    std::string key;
+    CachedResult cached;
+    if (astroid->plugin_manager->memoize) {
+      key = tag.raw () + "\x1f" + bg.raw ();
+      if (astroid->plugin_manager->cache_lookup (HookGetTagColors, key, cached)) {
+        return std::make_pair (cached.first, cached.second);
+      }
+    }
+
     for (PeasPluginInfo * p : astroid->plugin_manager->astroid_plugins) {
       PeasExtension * pe = peas_extension_set_get_extension (extensions, p);
 
-      GList * mclrs = astroid_activatable_get_tag_colors (ASTROID_ACTIVATABLE(pe), tag.c_str (), bg.c_str ());
+      GList * mclrs = NULL;
+      {
+        HookTimer t (HookGetTagColors);
+        mclrs = astroid_activatable_get_tag_colors (ASTROID_ACTIVATABLE(pe), tag.c_str (), bg.c_str ());
+      }
 
       if (mclrs != NULL) {
         std::vector<ustring> _mclrs = Glib::ListHandler<ustring>::list_to_vector (mclrs, Glib::OWNERSHIP_NONE);
@@ -238,6 +345,8 @@ namespace Astroid {
       }
     }
 
+    astroid->plugin_manager->cache_store (HookGetTagColors, key, { true, clrs.first, clrs.second });
+
     return clrs;
   }
 
@@ -274,6 +383,7 @@ namespace Astroid {
     for (PeasPluginInfo * p : astroid->plugin_manager->astroid_plugins) {
       PeasExtension * pe = peas_extension_set_get_extension (extensions, p);
 
+      HookTimer t (HookProcess);
       GMimeStream * ret = astroid_activatable_process (ASTROID_ACTIVATABLE(pe), fname);
       if(ret != NULL) return ret;
     }
@@ -281,6 +391,19 @@ namespace Astroid {
     return NULL;
   }
 
+  std::string PluginManager::Extension::format_tags_key (
+      const std::vector<ustring> & tags,
+      const ustring & bg,
+      bool selected) {
+    std::string key = bg.raw () + (selected ? "\x1f" "1" : "\x1f" "0");
+
+    for (auto &t : tags) {
+      key += "\x1f" + t.raw ();
+    }
+
+    return key;
+  }
+
   /* ********************
    * ThreadIndexExtension
    * ********************/
@@ -328,20 +451,36 @@ namespace Astroid {
       ustring &out) {
     if (!active || astroid->plugin_manager->disabled) return false;
 
+    std::string key;
+    CachedResult cached;
+    if (astroid->plugin_manager->memoize) {
+      key = "ti\x1f" + format_tags_key (tags, bg, selected);
+      if (astroid->plugin_manager->cache_lookup (HookFormatTags, key, cached)) {
+        if (cached.found) out = cached.first;
+        return cached.found;
+      }
+    }
+
     for (PeasPluginInfo * p : astroid->plugin_manager->thread_index_plugins) {
       PeasExtension * pe = peas_extension_set_get_extension (extensions, p);
 
       if (pe) {
 
-        char * tgs = astroid_threadindex_activatable_format_tags (ASTROID_THREADINDEX_ACTIVATABLE(pe), bg.c_str (), Glib::ListHandler<ustring>::vector_to_list (tags).data (), selected);
+        char * tgs = NULL;
+        {
+          HookTimer t (HookFormatTags);
+          tgs = astroid_threadindex_activatable_format_tags (ASTROID_THREADINDEX_ACTIVATABLE(pe), bg.c_str (), Glib::ListHandler<ustring>::vector_to_list (tags).data (), selected);
+        }
 
         if (tgs != NULL) {
           out = ustring (tgs);
+          astroid->plugin_manager->cache_store (HookFormatTags, key, { true, out, "" });
           return true;
         }
       }
     }
 
+    astroid->plugin_manager->cache_store (HookFormatTags, key, { false, "", "" });
     return false;
   }
 
@@ -385,17 +524,35 @@ namespace Astroid {
   bool PluginManager::ThreadViewExtension::get_avatar_uri (ustring email, ustring type, int size, refptr<Message> m, ustring &out) {
     if (!active || astroid->plugin_manager->disabled) return false;
 
+    /* when memoized the message is not part of the key: the avatar is
+     * assumed to only depend on the address. */
+    std::string key;
+    CachedResult cached;
+    if (astroid->plugin_manager->memoize) {
+      key = ustring::compose ("%1\x1f%2\x1f%3", email, type, size).raw ();
+      if (astroid->plugin_manager->cache_lookup (HookGetAvatarUri, key, cached)) {
+        if (cached.found) out = cached.first;
+        return cached.found;
+      }
+    }
+
     for (PeasPluginInfo * p : astroid->plugin_manager->thread_view_plugins) {
       PeasExtension * pe = peas_extension_set_get_extension (extensions, p);
 
-      char * uri = astroid_threadview_activatable_get_avatar_uri (ASTROID_THREADVIEW_ACTIVATABLE(pe), email.c_str (), type.c_str (), size, m->message);
+      char * uri = NULL;
+      {
+        HookTimer t (HookGetAvatarUri);
+        uri = astroid_threadview_activatable_get_avatar_uri (ASTROID_THREADVIEW_ACTIVATABLE(pe), email.c_str (), type.c_str (), size, m->message);
+      }
 
       if (uri != NULL) {
         out = ustring (uri);
+        astroid->plugin_manager->cache_store (HookGetAvatarUri, key, { true, out, "" });
         return true;
       }
     }
 
+    astroid->plugin_manager->cache_store (HookGetAvatarUri, key, { false, "", "" });
     return false;
   }
 
@@ -425,20 +582,36 @@ namespace Astroid {
       ustring &out) {
     if (!active || astroid->plugin_manager->disabled) return false;
 
+    std::string key;
+    CachedResult cached;
+    if (astroid->plugin_manager->memoize) {
+      key = "tv\x1f" + format_tags_key (tags, bg, selected);
+      if (astroid->plugin_manager->cache_lookup (HookFormatTags, key, cached)) {
+        if (cached.found) out = cached.first;
+        return cached.found;
+      }
+    }
+
     for (PeasPluginInfo * p : astroid->plugin_manager->thread_view_plugins) {
       PeasExtension * pe = peas_extension_set_get_extension (extensions, p);
 
       if (pe) {
 
-        char * tgs = astroid_threadview_activatable_format_tags (ASTROID_THREADVIEW_ACTIVATABLE(pe), bg.c_str (), Glib::ListHandler<ustring>::vector_to_list (tags).data (), selected);
+        char * tgs = NULL;
+        {
+          HookTimer t (HookFormatTags);
+          tgs = astroid_threadview_activatable_format_tags (ASTROID_THREADVIEW_ACTIVATABLE(pe), bg.c_str (), Glib::ListHandler<ustring>::vector_to_list (tags).data (), selected);
+        }
 
         if (tgs != NULL) {
           out = ustring (tgs);
+          astroid->plugin_manager->cache_store (HookFormatTags, key, { true, out, "" });
           return true;
         }
       }
     }
 
+    astroid->plugin_manager->cache_store (HookFormatTags, key, { false, "", "" });
     return false;
   }
 
@@ -454,7 +627,11 @@ namespace Astroid {
 
       if (pe) {
 
-        char * out = astroid_threadview_activatable_filter_part (ASTROID_THREADVIEW_ACTIVATABLE(pe), input_text.c_str (), input_html.c_str (), mime_type.c_str (), is_patch);
+        char * out = NULL;
+        {
+          HookTimer t (HookFilterPart);
+          out = astroid_threadview_activatable_filter_part (ASTROID_THREADVIEW_ACTIVATABLE(pe), input_text.c_str (), input_html.c_str (), mime_type.c_str (), is_patch);
+        }
 
         if (out != NULL) {
           input_html = std::string (out);
@@ -2,6 +2,10 @@
 
 # include <libpeas/peas.h>
 # include <vector>
+# include <map>
+# include <mutex>
+# include <atomic>
+# include <chrono>
 
 # include "astroid.hh"
 # include "proto.hh"
@@ -16,6 +20,61 @@ namespace Astroid {
 
       PeasEngine * engine;
 
+      /* hooks that are called on hot paths are timed */
+      enum Hook {
+        HookFormatTags = 0,
+        HookGetTagColors,
+        HookGetAvatarUri,
+        HookFilterPart,
+        HookProcess,
+        HookCount,
+      };
+
+      static const char * const hook_names[HookCount];
+
+      struct HookStats {
+        /* latency buckets: < 10us, < 100us, < 1ms, < 10ms, < 100ms, >= 100ms */
+        static const int BUCKETS = 6;
+
+        std::atomic<unsigned long> calls       {0};
+        std::atomic<unsigned long> cache_hits  {0};
+        std::atomic<unsigned long> total_us    {0};
+        std::atomic<unsigned long> max_us      {0};
+        std::atomic<unsigned long> histogram[BUCKETS] = {};
+
+        void add (unsigned long us);
+      };
+
+      HookStats hook_stats[HookCount];
+
+      /* write call counts and latency histograms to the log */
+      void log_hook_stats ();
+
+      class HookTimer {
+        public:
+          HookTimer (Hook);
+          ~HookTimer ();
+
+        private:
+          static const unsigned long SLOW_HOOK_US = 50000;
+
+          Hook hook;
+          std::chrono::time_point<std::chrono::steady_clock> t0;
+      };
+
+      /* results of pure hooks (tag formatting, tag colors and avatars)
+       * may be memoized by their arguments, enabled by the
+       * astroid.plugins.cache_pure_hooks option. */
+      struct CachedResult {
+        bool    found;
+        ustring first;
+        ustring second;
+      };
+
+      bool cache_lookup (Hook, const std::string & key, CachedResult & out);
+      void cache_store (Hook, const std::string & key, CachedResult r);
+      void cache_clear ();
+
       std::vector<PeasPluginInfo *>  astroid_plugins;
       std::vector<PeasPluginInfo *>  thread_index_plugins;
       std::vector<PeasPluginInfo *>  thread_view_plugins;
@@ -31,6 +90,9 @@ namespace Astroid {
           virtual ~Extension ();
 
           virtual void deactivate () = 0;
+
+        protected:
+          static std::string format_tags_key (const std::vector<ustring> & tags, const ustring & bg, bool selected);
       };
 
       class AstroidExtension : public Extension {
@@ -85,6 +147,11 @@ namespace Astroid {
     protected:
       bool disabled, test;
 
+      bool memoize = false;
+      static const size_t MAX_CACHED = 5000; // per hook
+      std::mutex hook_cache_m;
+      std::map<std::string, CachedResult> hook_cache[HookCount];
+
   };
 }
 
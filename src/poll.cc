@@ -27,6 +27,8 @@ namespace Astroid {
 
     poll_interval = astroid->config ().get<int> ("poll.interval");
     full_refresh  = astroid->config ().get<bool> ("poll.always_full_refresh");
+    watch_db      = astroid->config ().get<bool> ("poll.watch_db");
+    watch_delay   = astroid->config ().get<int> ("poll.watch_delay");
     LOG (debug) << "poll: interval: " << poll_interval;
 
     // check every 1 seconds if periodic poll has changed
@@ -49,9 +51,115 @@ namespace Astroid {
     } else {
       d_refresh.connect (sigc::mem_fun (this, &Poll::refresh_full));
     }
+
+    if (watch_db) start_watching ();
   }
 
   void Poll::close () {
+    stop_watching ();
+  }
+
+  void Poll::start_watching () {
+    /* the xapian database is in .notmuch in the mail root, or in the
+     * data directory with newer versions of notmuch */
+    const char * profile = getenv ("NOTMUCH_PROFILE");
+
+    vector<path> candidates = {
+      Db::path_db / ".notmuch" / "xapian",
+      path (Glib::get_user_data_dir ()) / "notmuch" / (profile ? profile : "default") / "xapian",
+    };
+
+    path xapian;
+    for (auto &c : candidates) {
+      if (is_directory (c)) {
+        xapian = c;
+        break;
+      }
+    }
+
+    if (xapian.empty ()) {
+      LOG (warn) << "poll: could not find xapian database, changes by other programs will only show after a poll.";
+      return;
+    }
+
+    {
+      Db db (Db::DbMode::DATABASE_READ_ONLY);
+      watch_revision = db.get_revision ();
+    }
+
+    try {
+      db_monitor = Gio::File::create_for_path (xapian.c_str ())->monitor_directory ();
+    } catch (Gio::Error &ex) {
+      LOG (error) << "poll: could not watch database: " << ex.what ();
+      return;
+    }
+
+    db_monitor->signal_changed ().connect (
+        sigc::mem_fun (this, &Poll::on_db_changed));
+
+    LOG (info) << "poll: watching database: " << xapian.c_str () << " (revision: " << watch_revision << ")";
+  }
+
+  void Poll::stop_watching () {
+    c_watch.disconnect ();
+
+    if (db_monitor) {
+      db_monitor->cancel ();
+      db_monitor.reset ();
+    }
+  }
+
+  void Poll::on_db_changed (
+      const refptr<Gio::File> & file,
+      const refptr<Gio::File> &,
+      Gio::FileMonitorEvent) {
+
+    /* xapian replaces its version file (iamglass, iamchert) on every
+     * commit, the other files change while the commit is written */
+    if (file->get_basename ().compare (0, 3, "iam") != 0) return;
+
+    /* collect bursts of commits into one refresh */
+    if (c_watch.connected ()) return;
+
+    c_watch = Glib::signal_timeout ().connect (
+        sigc::mem_fun (this, &Poll::on_watch_timeout), watch_delay);
+  }
+
+  bool Poll::on_watch_timeout () {
+    if (!m_dopoll.try_lock ()) {
+      /* the poll in progress will refresh when done */
+      LOG (debug) << "poll: database changed during poll.";
+      return false;
+    }
+
+    unsigned long revnow;
+    {
+      Db db (Db::DbMode::DATABASE_READ_ONLY);
+      revnow = db.get_revision ();
+    }
+
+    if (revnow > watch_revision) {
+      LOG (info) << "poll: database changed, revision: " << watch_revision << " -> " << revnow;
+
+      before_poll_revision = watch_revision;
+
+      if (full_refresh) {
+        refresh_full ();
+        watch_revision = revnow;
+      } else {
+        refresh_threads ();
+      }
+    }
+
+    m_dopoll.unlock ();
+
+    return false;
+  }
+
+  void Poll::db_written (unsigned long before, unsigned long after) {
+    /* only skip the changes if nothing else has changed the db since the
+     * watcher last looked */
+    watch_revision.compare_exchange_strong (before, after);
   }
 
   void Poll::start_polling () {
@@ -331,6 +439,9 @@ namespace Astroid {
     unsigned long revnow = db.get_revision ();
     LOG (debug) << "poll: refreshing.. revision after poll: " << revnow;
 
+    /* the watcher does not need to refresh these again */
+    if (revnow > watch_revision) watch_revision = revnow;
+
     if (revnow > before_poll_revision) {
 
       ustring query = ustring::compose ("lastmod:%1..%2",
@@ -6,7 +6,10 @@
 # include <mutex>
 # include <condition_variable>
 # include <chrono>
+# include <atomic>
 # include <glibmm/iochannel.h>
+# include <giomm/file.h>
+# include <giomm/filemonitor.h>
 
 namespace Astroid {
   class Poll : public sigc::trackable {
@@ -26,6 +29,10 @@ namespace Astroid {
       void refresh (unsigned long before);
       void cancel_poll ();
 
+      /* a read-write db opened at revision before was closed at revision
+       * after, those changes do not need to be picked up by the watcher */
+      void db_written (unsigned long before, unsigned long after);
+
     private:
       std::mutex m_dopoll;
 
@@ -59,6 +66,20 @@ namespace Astroid {
 
       Glib::Dispatcher d_refresh;
 
+      /* watch the xapian directory for commits by other programs and
+       * refresh the threads changed since the last seen revision */
+      bool watch_db    = true;
+      int  watch_delay = 500; // ms
+      std::atomic<unsigned long> watch_revision {0};
+
+      refptr<Gio::FileMonitor> db_monitor;
+      sigc::connection c_watch;
+
+      void start_watching ();
+      void stop_watching ();
+      void on_db_changed (const refptr<Gio::File> &, const refptr<Gio::File> &, Gio::FileMonitorEvent);
+      bool on_watch_timeout ();
+
       bool log_out (Glib::IOCondition);
       bool log_err (Glib::IOCondition);
 
@@ -24,6 +24,7 @@ namespace Astroid {
   //class Contacts;
   class Poll;
   class PluginManager;
+  class FilterProcess;
 
   /* message and thread */
   class Message;
@@ -1,4 +1,5 @@
 # include <iostream>
+# include <algorithm>
 
 # include <boost/property_tree/ptree.hpp>
 # include <glibmm/datetime.h>
@@ -60,6 +61,106 @@ namespace Astroid {
 
   Date::ClockFormat Date::clock_format;
 
+  std::unordered_map<time_t, Date::CachedDate> Date::date_cache;
+  std::map<std::pair<int, int>, ustring> Date::day_cache;
+  time_t Date::cache_midnight = 0;
+  bool Date::same_year_date_only = false;
+  bool Date::diff_year_date_only = false;
+
+  ustring Date::pretty_print_cached (time_t t) {
+    time_t now = time (NULL);
+
+    if (now >= cache_midnight || date_cache.size () >= MAX_CACHED_DATES) {
+      /* every coarse date may change at midnight */
+      date_cache.clear ();
+      day_cache.clear ();
+
+      struct tm mt = *localtime (&now);
+      mt.tm_sec   = 0;
+      mt.tm_min   = 0;
+      mt.tm_hour  = 0;
+      mt.tm_mday += 1;
+      mt.tm_isdst = -1;
+      cache_midnight = mktime (&mt);
+    }
+
+    auto c = date_cache.find (t);
+    if (c != date_cache.end () && now < c->second.valid_until) {
+      return c->second.str;
+    }
+
+    struct tm local_time = *localtime (&t);
+    time_t diff = now - t;
+
+    CoarseDate cd = coarse_date (t);
+
+    time_t valid_until = cache_midnight;
+    bool   per_day     = false;
+
+    if (clock_format == ClockFormat::YEAR) {
+      per_day = (cd == CoarseDate::YEARS || cd == CoarseDate::FUTURE) ? diff_year_date_only : same_year_date_only;
+      if (cd == CoarseDate::FUTURE) valid_until = std::min (valid_until, now + 60);
+
+    } else {
+      switch (cd) {
+        case CoarseDate::NOW:
+          valid_until = t + 60;
+          break;
+
+        case CoarseDate::MINUTES:
+          valid_until = t + 60 * (diff / 60 + 1);
+          break;
+
+        case CoarseDate::HOURS:
+          valid_until = t + 60 * 60 * (diff / (60 * 60) + 1);
+          break;
+
+        case CoarseDate::FUTURE:
+          valid_until = now + 60;
+          break;
+
+        case CoarseDate::YESTERDAY:
+        case CoarseDate::THIS_WEEK:
+          per_day = true;
+          break;
+
+        case CoarseDate::THIS_YEAR:
+          per_day = same_year_date_only;
+          break;
+
+        case CoarseDate::YEARS:
+          per_day = diff_year_date_only;
+          break;
+
+        default:
+          break;
+      }
+
+      valid_until = std::min (valid_until, cache_midnight);
+    }
+
+    ustring str;
+
+    if (per_day) {
+      auto key = std::make_pair ((local_time.tm_year + 1900) * 1000 + local_time.tm_yday, (int) cd);
+      auto d   = day_cache.find (key);
+
+      if (d != day_cache.end ()) {
+        str = d->second;
+      } else {
+        str = pretty_print (t);
+        day_cache[key] = str;
+      }
+
+    } else {
+      str = pretty_print (t);
+    }
+
+    date_cache[t] = { str, valid_until };
+
+    return str;
+  }
+
   ustring Date::pretty_print (time_t t) {
     struct tm * temp_t = localtime (&t);
     struct tm local_time = *temp_t;
@@ -175,6 +276,29 @@ namespace Astroid {
 
     /* diff year */
     diff_year = config.get<string>("diff_year");
+
+    same_year_date_only = is_date_only (same_year);
+    diff_year_date_only = is_date_only (diff_year);
+
+    date_cache.clear ();
+    day_cache.clear ();
+    cache_midnight = 0;
+  }
+
+  bool Date::is_date_only (ustring fmt) {
+    /* no time of day in format, the result is the same for the whole day */
+    std::string f = fmt.raw ();
+
+    for (std::string::size_type i = f.find ('%'); i != std::string::npos; i = f.find ('%', i + 1)) {
+      i++;
+      while (i < f.size () && std::string ("-_0^#").find (f[i]) != std::string::npos) i++;
+
+      if (i < f.size () && std::string ("HIklMSpPrRTXcs").find (f[i]) != std::string::npos) {
+        return false;
+      }
+    }
+
+    return true;
   }
 
   Date::CoarseDate Date::coarse_date (time_t t) {
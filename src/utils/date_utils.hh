@@ -1,5 +1,8 @@
 # pragma once
 
+# include <unordered_map>
+# include <map>
+
 # include "astroid.hh"
 
 namespace Astroid {
@@ -46,8 +49,28 @@ namespace Astroid {
       static ustring pretty_print (time_t );
       static ustring pretty_print_verbose (time_t, bool = false);
 
+      /* same as pretty_print, but the result is kept until the coarse
+       * date or the relative time shown changes. meant for the thread
+       * index which redraws all visible dates every minute. */
+      static ustring pretty_print_cached (time_t);
+
       static ustring asctime (time_t t);
 
       static void init ();
+
+    private:
+      struct CachedDate {
+        ustring str;
+        time_t  valid_until;
+      };
+
+      static std::unordered_map<time_t, CachedDate> date_cache;
+      static std::map<std::pair<int, int>, ustring> day_cache; // by day and coarse date
+      static time_t cache_midnight;
+      static const size_t MAX_CACHED_DATES = 10000;
+
+      static bool same_year_date_only;
+      static bool diff_year_date_only;
+      static bool is_date_only (ustring fmt);
   };
 }
@@ -0,0 +1,409 @@
+# include <cerrno>
+# include <pthread.h>
+# include <vector>
+# include <signal.h>
+# include <poll.h>
+# include <unistd.h>
+# include <fcntl.h>
+# include <sys/wait.h>
+
+# include "astroid.hh"
+# include "filter_process.hh"
+
+using std::string;
+
+namespace Astroid {
+  FilterProcess::FilterProcess (
+      ustring _name,
+      ustring _oneshot_cmd,
+      ustring _persistent_cmd,
+      int _timeout) :
+    name (_name),
+    oneshot_cmd (_oneshot_cmd),
+    persistent_cmd (_persistent_cmd),
+    timeout (_timeout)
+  {
+    d_done.connect (sigc::mem_fun (this, &FilterProcess::on_done));
+
+    worker = std::thread (&FilterProcess::work, this);
+  }
+
+  FilterProcess::~FilterProcess () {
+    close ();
+  }
+
+  void FilterProcess::close () {
+    {
+      std::lock_guard<std::mutex> lk (queue_m);
+      if (!running) return;
+      running = false;
+    }
+
+    queue_cv.notify_all ();
+    if (worker.joinable ()) worker.join ();
+  }
+
+  FilterProcess::Result FilterProcess::convert (ustring input) {
+    std::unique_ptr<Request> r (new Request ());
+    r->input = input;
+
+    Result res = r->result.get_future ().share ();
+
+    {
+      std::lock_guard<std::mutex> lk (queue_m);
+      queue.push_back (std::move (r));
+    }
+
+    queue_cv.notify_one ();
+    return res;
+  }
+
+  bool FilterProcess::wait (Result res, ustring & text) {
+    ustring error;
+    return wait (res, text, error);
+  }
+
+  bool FilterProcess::wait (Result res, ustring & text, ustring & error) {
+    if (timeout > 0 &&
+        res.wait_for (std::chrono::milliseconds (timeout)) != std::future_status::ready) {
+      LOG (error) << "fp: " << name << ": timed out.";
+      error = "Timed out waiting for " + name + " processor.";
+      return false;
+    }
+
+    const Output & r = res.get ();
+    error = r.error;
+
+    if (!r.success) return false;
+
+    text = r.text;
+    if (!text.validate ()) {
+      LOG (warn) << "fp: " << name << ": output is not valid utf-8, assuming latin-1.";
+      text = Glib::convert_with_fallback (r.text, "UTF-8", "ISO-8859-1");
+    }
+
+    return true;
+  }
+
+  void FilterProcess::work () {
+    /* a co-process that has died should give EPIPE, not kill us */
+    sigset_t set;
+    sigemptyset (&set);
+    sigaddset (&set, SIGPIPE);
+    pthread_sigmask (SIG_BLOCK, &set, NULL);
+
+    while (true) {
+      std::unique_ptr<Request> r;
+
+      {
+        std::unique_lock<std::mutex> lk (queue_m);
+        queue_cv.wait (lk, [&] { return !running || !queue.empty (); });
+
+        if (!running) break;
+
+        r = std::move (queue.front ());
+        queue.pop_front ();
+      }
+
+      Output out = { false, "", "" };
+
+      if (!persistent_cmd.empty () && !disabled) {
+        if (!persistent_convert (r->input, out)) {
+          LOG (warn) << "fp: " << name << ": co-process failed, falling back to: " << oneshot_cmd;
+          stop ();
+        }
+      }
+
+      if (!out.success && !oneshot_cmd.empty ()) {
+        oneshot_convert (r->input, out);
+      }
+
+      r->result.set_value (out);
+      d_done.emit ();
+    }
+
+    /* fail anything left over */
+    std::lock_guard<std::mutex> lk (queue_m);
+    for (auto &r : queue) r->result.set_value ({ false, "", "" });
+    queue.clear ();
+
+    stop ();
+  }
+
+  FilterProcess::type_signal_done FilterProcess::signal_done () {
+    return m_signal_done;
+  }
+
+  void FilterProcess::on_done () {
+    m_signal_done.emit ();
+  }
+
+  bool FilterProcess::oneshot_convert (const string & in, Output & out) {
+    LOG (info) << "fp: " << name << ": running: " << oneshot_cmd;
+
+    GPid cpid = 0;
+    int  fds[3] = { -1, -1, -1 }; /* stdin, stdout and stderr */
+
+    try {
+      std::vector<std::string> args = Glib::shell_parse_argv (oneshot_cmd);
+
+      Glib::spawn_async_with_pipes ("",
+          args,
+          Glib::SPAWN_DO_NOT_REAP_CHILD |
+          Glib::SPAWN_SEARCH_PATH,
+          sigc::slot <void> (),
+          &cpid,
+          &fds[0],
+          &fds[1],
+          &fds[2]);
+
+    } catch (Glib::Error &ex) {
+      LOG (error) << "fp: " << name << ": failed to execute: '" << oneshot_cmd << "': " << ex.what ();
+      out.error = ex.what ();
+      return false;
+    }
+
+    for (int fd : fds) fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK);
+
+    gint64 deadline = timeout > 0 ? g_get_monotonic_time () + timeout * 1000 : 0;
+
+    /* write the input while reading the output, so that neither pipe can
+     * fill up and block the process */
+    std::string * sinks[3] = { NULL, &out.text, &out.error };
+    size_t written   = 0;
+    bool   timed_out = false;
+
+    if (in.empty ()) {
+      ::close (fds[0]);
+      fds[0] = -1;
+    }
+
+    while (fds[0] >= 0 || fds[1] >= 0 || fds[2] >= 0) {
+      int ms = -1;
+
+      if (deadline > 0) {
+        gint64 left = deadline - g_get_monotonic_time ();
+        if (left <= 0) {
+          timed_out = true;
+          break;
+        }
+        ms = static_cast<int> ((left + 999) / 1000);
+      }
+
+      /* closed pipes have a negative fd and are skipped by poll */
+      struct pollfd p[3] = {
+        { fds[0], POLLOUT, 0 },
+        { fds[1], POLLIN,  0 },
+        { fds[2], POLLIN,  0 },
+      };
+
+      int r = ::poll (p, 3, ms);
+      if (r < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+
+      if (p[0].revents) {
+        ssize_t n = ::write (fds[0], in.data () + written, in.size () - written);
+        if (n > 0) written += n;
+
+        if (written == in.size () || (n < 0 && errno != EINTR && errno != EAGAIN)) {
+          ::close (fds[0]);
+          fds[0] = -1;
+        }
+      }
+
+      for (int i = 1; i < 3; i++) {
+        if (!p[i].revents) continue;
+
+        char buf[4096];
+        ssize_t n = ::read (fds[i], buf, sizeof (buf));
+
+        if (n > 0) {
+          sinks[i]->append (buf, n);
+        } else if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+          ::close (fds[i]);
+          fds[i] = -1;
+        }
+      }
+    }
+
+    for (int &fd : fds) {
+      if (fd >= 0) ::close (fd);
+      fd = -1;
+    }
+
+    if (timed_out) {
+      LOG (error) << "fp: " << name << ": timed out, killing: " << oneshot_cmd;
+      kill (cpid, SIGKILL);
+    }
+
+    waitpid (cpid, NULL, 0);
+    g_spawn_close_pid (cpid);
+
+    if (timed_out) {
+      out.error = "Timed out waiting for " + name + " processor.";
+      return false;
+    }
+
+    if (!out.error.empty ()) {
+      LOG (error) << "fp: " << name << ": " << out.error;
+    }
+
+    out.success = true;
+    return true;
+  }
+
+  bool FilterProcess::start () {
+    if (pid) return true;
+
+    LOG (info) << "fp: " << name << ": starting co-process: " << persistent_cmd;
+
+    try {
+      std::vector<std::string> args = Glib::shell_parse_argv (persistent_cmd);
+
+      Glib::spawn_async_with_pipes ("",
+          args,
+          Glib::SPAWN_DO_NOT_REAP_CHILD |
+          Glib::SPAWN_SEARCH_PATH,
+          sigc::slot <void> (),
+          &pid,
+          &fd_stdin,
+          &fd_stdout,
+          NULL);
+
+    } catch (Glib::Error &ex) {
+      LOG (error) << "fp: " << name << ": failed to start co-process: '" << persistent_cmd << "': " << ex.what ();
+      pid = 0;
+      disabled = true;
+      return false;
+    }
+
+    return true;
+  }
+
+  void FilterProcess::stop () {
+    if (!pid) return;
+
+    LOG (debug) << "fp: " << name << ": stopping co-process.";
+
+    ::close (fd_stdin);
+    ::close (fd_stdout);
+    fd_stdin  = -1;
+    fd_stdout = -1;
+
+    kill (pid, SIGTERM);
+    waitpid (pid, NULL, 0);
+    g_spawn_close_pid (pid);
+    pid = 0;
+  }
+
+  bool FilterProcess::persistent_convert (const string & in, Output & output) {
+    if (!start ()) return false;
+
+    gint64 deadline = timeout > 0 ? g_get_monotonic_time () + timeout * 1000 : 0;
+
+    string header = std::to_string (in.size ()) + "\n";
+    if (!write_all (header.data (), header.size (), deadline) ||
+        !write_all (in.data (), in.size (), deadline)) {
+      LOG (error) << "fp: " << name << ": failed to write to co-process.";
+      return false;
+    }
+
+    /* read length */
+    size_t len = 0;
+    char c;
+    int digits = 0;
+
+    while (true) {
+      if (!read_all (&c, 1, deadline)) {
+        LOG (error) << "fp: " << name << ": failed to read from co-process.";
+        return false;
+      }
+
+      if (c == '\n' && digits > 0) break;
+
+      if (c < '0' || c > '9' || digits > 12) {
+        LOG (error) << "fp: " << name << ": invalid frame from co-process.";
+        return false;
+      }
+
+      len = len * 10 + (c - '0');
+      digits++;
+    }
+
+    if (len > MAX_FRAME) {
+      LOG (error) << "fp: " << name << ": frame from co-process too large: " << len;
+      return false;
+    }
+
+    std::string & out = output.text;
+    out.resize (len);
+    if (len > 0 && !read_all (&out[0], len, deadline)) {
+      LOG (error) << "fp: " << name << ": failed to read from co-process.";
+      return false;
+    }
+
+    output.success = true;
+    output.error   = "";
+    coprocess_conversions++;
+    return true;
+  }
+
+  bool FilterProcess::wait_fd (int fd, short events, gint64 deadline) {
+    while (true) {
+      int ms = -1;
+
+      if (deadline > 0) {
+        gint64 left = deadline - g_get_monotonic_time ();
+        if (left <= 0) {
+          LOG (error) << "fp: " << name << ": co-process timed out.";
+          return false;
+        }
+        ms = static_cast<int> ((left + 999) / 1000);
+      }
+
+      struct pollfd p = { fd, events, 0 };
+      int r = ::poll (&p, 1, ms);
+
+      if (r > 0) return true;
+      if (r < 0 && errno != EINTR) return false;
+    }
+  }
+
+  bool FilterProcess::write_all (const char * buf, size_t len, gint64 deadline) {
+    while (len > 0) {
+      if (!wait_fd (fd_stdin, POLLOUT, deadline)) return false;
+
+      ssize_t n = ::write (fd_stdin, buf, len);
+      if (n < 0) {
+        if (errno == EINTR || errno == EAGAIN) continue;
+        return false;
+      }
+
+      buf += n;
+      len -= n;
+    }
+
+    return true;
+  }
+
+  bool FilterProcess::read_all (char * buf, size_t len, gint64 deadline) {
+    while (len > 0) {
+      if (!wait_fd (fd_stdout, POLLIN, deadline)) return false;
+
+      ssize_t n = ::read (fd_stdout, buf, len);
+      if (n == 0) return false; /* co-process exited */
+      if (n < 0) {
+        if (errno == EINTR || errno == EAGAIN) continue;
+        return false;
+      }
+
+      buf += n;
+      len -= n;
+    }
+
+    return true;
+  }
+}
+
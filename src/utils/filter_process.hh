@@ -0,0 +1,102 @@
+# pragma once
+
+# include <string>
+# include <deque>
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+# include <future>
+# include <memory>
+# include <atomic>
+
+# include <glibmm.h>
+
+# include "proto.hh"
+
+namespace Astroid {
+  /* runs text through an external filter, e.g. html to text for quoting
+   * in replies or markdown to html when composing.
+   *
+   * if a persistent command is set it is started once and kept running,
+   * every conversion is then sent as a frame:
+   *
+   *   <length in bytes>\n<input>
+   *
+   * and the output is expected back in the same format. otherwise (or if
+   * the co-process fails) the one-shot command is run for every input.
+   *
+   * conversions are done on a worker thread, the caller waits at most
+   * timeout ms for each. a process that takes longer is killed. callers
+   * that do not want to wait can use signal_done, which is emitted on the
+   * gui thread when a conversion is finished.
+   */
+  class FilterProcess {
+    public:
+      FilterProcess (ustring name, ustring oneshot_cmd, ustring persistent_cmd, int timeout);
+      ~FilterProcess ();
+
+      struct Output {
+        bool        success;
+        std::string text;
+        std::string error; /* stderr of one-shot command */
+      };
+
+      typedef std::shared_future<Output> Result;
+
+      /* queue input for conversion */
+      Result convert (ustring input);
+
+      /* wait for result, returns false on error or timeout */
+      bool wait (Result, ustring & text);
+      bool wait (Result, ustring & text, ustring & error);
+
+      void close ();
+
+      /* conversions done by the co-process */
+      std::atomic<unsigned int> coprocess_conversions { 0 };
+
+      typedef sigc::signal <void> type_signal_done;
+      type_signal_done signal_done ();
+
+    private:
+      ustring name;
+      ustring oneshot_cmd;
+      ustring persistent_cmd;
+      int     timeout; /* ms */
+
+      struct Request {
+        std::string input;
+        std::promise<Output> result;
+      };
+
+      std::deque<std::unique_ptr<Request>> queue;
+      std::mutex queue_m;
+      std::condition_variable queue_cv;
+      bool running = true;
+      std::thread worker;
+
+      void work ();
+
+      Glib::Dispatcher d_done;
+      type_signal_done m_signal_done;
+      void on_done ();
+
+      /* co-process, only touched by the worker */
+      GPid  pid       = 0;
+      int   fd_stdin  = -1;
+      int   fd_stdout = -1;
+      bool  disabled  = false; /* failed to start, use one-shot */
+
+      bool start ();
+      void stop ();
+      bool persistent_convert (const std::string & in, Output & out);
+      bool oneshot_convert (const std::string & in, Output & out);
+
+      bool write_all (const char * buf, size_t len, gint64 deadline);
+      bool read_all (char * buf, size_t len, gint64 deadline);
+      bool wait_fd (int fd, short events, gint64 deadline);
+
+      static const size_t MAX_FRAME = 64 * 1024 * 1024;
+  };
+}
+
@@ -29,6 +29,10 @@
 #include <stdio.h>
 #include <string.h>
 
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
 # include "url-scanner.h"
 # include <gmime/gmime-filter-html.h>
 # include "gmime-filter-html-bq.h"
@@ -95,6 +99,8 @@ static void filter_reset (GMimeFilter *filter);
 
 static GMimeFilterClass *parent_class = NULL;
 
+static gboolean use_fast_path = TRUE;
+
 
 GType
 g_mime_filter_html_bq_get_type (void)
@@ -288,6 +294,90 @@ html_utf8_getc (const unsigned char **in, const unsigned char *inend)
 	return 0xffff;
 }
 
+/* length of the run of bytes at the start of in that can be copied to
+ * the output as they are: printable ascii that does not need escaping
+ * (spaces only when they are not converted). */
+static inline size_t
+plain_run (const unsigned char *in, const unsigned char *inend, gboolean spaces)
+{
+	const unsigned char *inptr = in;
+
+#if defined (__SSE2__)
+	const __m128i lt  = _mm_set1_epi8 ('<');
+	const __m128i gt  = _mm_set1_epi8 ('>');
+	const __m128i amp = _mm_set1_epi8 ('&');
+	const __m128i quo = _mm_set1_epi8 ('"');
+	const __m128i spc = _mm_set1_epi8 (spaces ? ' ' : '<');
+	const __m128i ctl = _mm_set1_epi8 (0x20);
+
+	while (inptr + 16 <= inend) {
+		__m128i v = _mm_loadu_si128 ((const __m128i *) inptr);
+
+		/* signed compare: control characters and bytes >= 0x80 */
+		__m128i m = _mm_cmplt_epi8 (v, ctl);
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (v, lt));
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (v, gt));
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (v, amp));
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (v, quo));
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (v, spc));
+
+		int mask = _mm_movemask_epi8 (m);
+		if (mask)
+			return (inptr - in) + __builtin_ctz (mask);
+
+		inptr += 16;
+	}
+#endif
+
+	while (inptr < inend) {
+		unsigned char c = *inptr;
+
+		if (c < 0x20 || c >= 0x80 || c == '<' || c == '>' || c == '&' || c == '"' || (spaces && c == ' '))
+			break;
+
+		inptr++;
+	}
+
+	return inptr - in;
+}
+
+/* whether a url or address could start in the line: all patterns contain
+ * ':', '.' or '@'. */
+static inline gboolean
+may_contain_url (const char *in, size_t len)
+{
+	const char *inptr = in;
+	const char *inend = in + len;
+
+#if defined (__SSE2__)
+	const __m128i col = _mm_set1_epi8 (':');
+	const __m128i dot = _mm_set1_epi8 ('.');
+	const __m128i at  = _mm_set1_epi8 ('@');
+
+	while (inptr + 16 <= inend) {
+		__m128i v = _mm_loadu_si128 ((const __m128i *) inptr);
+
+		__m128i m = _mm_cmpeq_epi8 (v, col);
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (v, dot));
+		m = _mm_or_si128 (m, _mm_cmpeq_epi8 (v, at));
+
+		if (_mm_movemask_epi8 (m))
+			return TRUE;
+
+		inptr += 16;
+	}
+#endif
+
+	while (inptr < inend) {
+		if (*inptr == ':' || *inptr == '.' || *inptr == '@')
+			return TRUE;
+
+		inptr++;
+	}
+
+	return FALSE;
+}
+
 static char *
 writeln (GMimeFilter *filter, const char *in, const char *end, char *outptr, char **outend)
 {
@@ -296,9 +386,38 @@ writeln (GMimeFilter *filter, const char *in, const char *end, char *outptr, cha
 	const unsigned char *inend = (const unsigned char *) end;
 	const unsigned char *inptr = instart;
 
+	gboolean spaces = (html->flags & GMIME_FILTER_HTML_CONVERT_SPACES) != 0;
+
 	while (inptr < inend) {
 		gunichar u;
 
+		if (use_fast_path) {
+			const unsigned char *run = inptr;
+
+			for (;;) {
+				inptr += plain_run (inptr, inend, spaces);
+
+				/* a single space inside the line is not converted */
+				if (spaces && inptr + 1 < inend && *inptr == ' ' && inptr != instart &&
+				    inptr[1] != ' ' && inptr[1] != '\t') {
+					inptr++;
+					continue;
+				}
+
+				break;
+			}
+
+			if (inptr > run) {
+				size_t n = inptr - run;
+
+				outptr = check_size (filter, outptr, outend, n);
+				memcpy (outptr, run, n);
+				outptr += n;
+				html->column += n;
+				continue;
+			}
+		}
+
 		outptr = check_size (filter, outptr, outend, 16);
 
 		u = html_utf8_getc (&inptr, inend);
@@ -385,8 +504,13 @@ html_convert (GMimeFilter *filter, char *in, size_t inlen, size_t prespace,
 	}
 
 	do {
-		while (inptr < inend && *inptr != '\n')
-			inptr++;
+		if (use_fast_path) {
+			inptr = memchr (inptr, '\n', inend - inptr);
+			if (!inptr) inptr = (char *) inend;
+		} else {
+			while (inptr < inend && *inptr != '\n')
+				inptr++;
+		}
 
 		if (inptr == inend && !flush)
 			break;
@@ -457,7 +581,8 @@ html_convert (GMimeFilter *filter, char *in, size_t inlen, size_t prespace,
 			len = inptr - start;
 
 			do {
-				if (url_scanner_scan (html->scanner, start, len, &match)) {
+				if ((!use_fast_path || may_contain_url (start, len)) &&
+				    url_scanner_scan (html->scanner, start, len, &match)) {
 					/* write out anything before the first regex match */
 					outptr = writeln (filter, start, start + match.um_so,
 							  outptr, &outend);
@@ -564,6 +689,21 @@ filter_reset (GMimeFilter *filter)
 }
 
 
+/**
+ * g_mime_filter_html_bq_set_fast_path:
+ * @enable: use the fast path
+ *
+ * Enable or disable skipping runs of text that need no escaping and
+ * lines that cannot contain urls in bulk. Only useful for comparing
+ * the output and throughput.
+ **/
+void
+g_mime_filter_html_bq_set_fast_path (gboolean enable)
+{
+	use_fast_path = enable;
+}
+
+
 /**
  * g_mime_filter_html_bq_new:
  * @flags: html flags
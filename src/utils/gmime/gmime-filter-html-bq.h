@@ -83,6 +83,8 @@ GType g_mime_filter_html_bq_get_type (void);
 
 GMimeFilter *g_mime_filter_html_bq_new (guint32 flags, guint32 colour);
 
+void g_mime_filter_html_bq_set_fast_path (gboolean enable);
+
 G_END_DECLS
 
 #endif /* __GMIME_filter_html_bq_BQ_H__ */
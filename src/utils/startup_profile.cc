@@ -0,0 +1,72 @@
+# include <iostream>
+# include <iomanip>
+# include <sstream>
+
+# include "astroid.hh"
+# include "startup_profile.hh"
+
+namespace Astroid {
+  bool StartupProfile::print = false;
+  std::mutex StartupProfile::m;
+  std::vector<StartupProfile::Phase> StartupProfile::phases;
+  gint64 StartupProfile::start = 0;
+  gint64 StartupProfile::last  = 0;
+  bool StartupProfile::finished = false;
+
+  void StartupProfile::begin () {
+    std::lock_guard<std::mutex> lk (m);
+    start = last = g_get_monotonic_time ();
+    phases.clear ();
+    finished = false;
+  }
+
+  void StartupProfile::phase (ustring name) {
+    std::lock_guard<std::mutex> lk (m);
+    if (finished || !start) return;
+
+    gint64 now = g_get_monotonic_time ();
+    phases.push_back ({ name, now - last });
+    last = now;
+  }
+
+  void StartupProfile::done () {
+    phase ("first rows");
+
+    {
+      std::lock_guard<std::mutex> lk (m);
+      if (finished || !start) return;
+      finished = true;
+    }
+
+    log ();
+  }
+
+  void StartupProfile::log () {
+    std::lock_guard<std::mutex> lk (m);
+
+    if (phases.empty ()) {
+      LOG (info) << "startup: no startup profile recorded.";
+      return;
+    }
+
+    gint64 total = 0;
+    std::ostringstream out;
+
+    out << "startup: profile (ms):" << std::endl;
+
+    for (auto &p : phases) {
+      total += p.duration;
+      out << "  " << std::setw (24) << std::left << p.name
+          << std::setw (10) << std::right << std::fixed << std::setprecision (1) << (p.duration / 1000.0)
+          << std::setw (10) << (total / 1000.0) << std::endl;
+    }
+
+    LOG (info) << out.str ();
+
+    if (print && finished) {
+      std::cout << out.str () << std::flush;
+      print = false; /* only once */
+    }
+  }
+}
+
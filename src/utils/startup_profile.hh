@@ -0,0 +1,38 @@
+# pragma once
+
+# include <vector>
+# include <mutex>
+
+# include "astroid.hh"
+
+namespace Astroid {
+  /* records the wall time of each startup phase until the first rows of
+   * the first thread index have been loaded. */
+  class StartupProfile {
+    public:
+      static void begin ();
+
+      /* end current phase */
+      static void phase (ustring name);
+
+      /* first rows are shown, startup is done */
+      static void done ();
+
+      static void log ();
+
+      static bool print; /* write to stdout when done (--startup-profile) */
+
+    private:
+      struct Phase {
+        ustring name;
+        gint64  duration; /* us */
+      };
+
+      static std::mutex m;
+      static std::vector<Phase> phases;
+      static gint64 start;
+      static gint64 last;
+      static bool   finished;
+  };
+}
+
@@ -0,0 +1,121 @@
+# include <algorithm>
+
+# include "tag_trie.hh"
+
+namespace Astroid {
+  TagTrie::TagTrie () {
+  }
+
+  void TagTrie::clear () {
+    root.children.clear ();
+    root.entries.clear ();
+    entries.clear ();
+    present = 0;
+  }
+
+  std::string TagTrie::key (const ustring & tag) {
+    return tag.casefold ();
+  }
+
+  const TagTrie::Node * TagTrie::find (const std::string & k) const {
+    const Node * n = &root;
+
+    for (char c : k) {
+      auto f = n->children.find (c);
+      if (f == n->children.end ()) return NULL;
+      n = f->second.get ();
+    }
+
+    return n;
+  }
+
+  int TagTrie::lookup (const ustring & tag) const {
+    const Node * n = find (key (tag));
+    if (n == NULL) return -1;
+
+    for (int i : n->entries) {
+      if (entries[i].name == tag) return i;
+    }
+
+    return -1;
+  }
+
+  bool TagTrie::insert (const ustring & tag) {
+    if (tag.empty ()) return false;
+
+    int i = lookup (tag);
+
+    if (i >= 0) {
+      if (entries[i].present) return false;
+
+      entries[i].present = true;
+      present++;
+      return true;
+    }
+
+    Node * n = &root;
+    for (char c : key (tag)) {
+      std::unique_ptr<Node> &child = n->children[c];
+      if (!child) child.reset (new Node ());
+      n = child.get ();
+    }
+
+    n->entries.push_back (entries.size ());
+    entries.push_back ({ tag, 0, true });
+    present++;
+
+    return true;
+  }
+
+  void TagTrie::update (const std::vector<ustring> & tags) {
+    for (Entry &e : entries) e.present = false;
+    present = 0;
+
+    for (const ustring &t : tags) insert (t);
+  }
+
+  void TagTrie::use (const ustring & tag) {
+    int i = lookup (tag);
+    if (i >= 0) entries[i].uses++;
+  }
+
+  void TagTrie::collect (const Node * n, std::vector<int> & out) const {
+    for (int i : n->entries) {
+      if (entries[i].present) out.push_back (i);
+    }
+
+    for (auto &c : n->children) collect (c.second.get (), out);
+  }
+
+  std::vector<ustring> TagTrie::complete (const ustring & prefix, unsigned int max) const {
+    std::vector<ustring> out;
+
+    const Node * n = find (key (prefix));
+    if (n == NULL) return out;
+
+    std::vector<int> matches;
+    collect (n, matches);
+
+    auto better = [&] (int a, int b) {
+      if (entries[a].uses != entries[b].uses)
+        return entries[a].uses > entries[b].uses;
+      return entries[a].name < entries[b].name;
+    };
+
+    if (matches.size () > max) {
+      std::partial_sort (matches.begin (), matches.begin () + max, matches.end (), better);
+      matches.resize (max);
+    } else {
+      std::sort (matches.begin (), matches.end (), better);
+    }
+
+    for (int i : matches) out.push_back (entries[i].name);
+
+    return out;
+  }
+
+  unsigned int TagTrie::size () const {
+    return present;
+  }
+}
+
@@ -0,0 +1,56 @@
+# pragma once
+
+# include <vector>
+# include <map>
+# include <memory>
+
+# include "astroid.hh"
+
+namespace Astroid {
+  /* prefix tree over the case-folded tag names, used to complete tags
+   * in the command bar. completions are ranked by how often a tag has been
+   * used in this session, then by name. */
+  class TagTrie {
+    public:
+      TagTrie ();
+
+      void clear ();
+
+      /* set the known tags, new tags are added and tags no longer in the
+       * list are hidden. usage counts are kept. */
+      void update (const std::vector<ustring> &);
+
+      /* add tag, returns false if it was already present */
+      bool insert (const ustring &);
+
+      /* count use of tag, unknown tags are ignored */
+      void use (const ustring &);
+
+      /* the at most max best ranked tags starting with prefix */
+      std::vector<ustring> complete (const ustring & prefix, unsigned int max) const;
+
+      unsigned int size () const;
+
+    private:
+      struct Node {
+        std::map<char, std::unique_ptr<Node>> children;
+        std::vector<int> entries; /* tags with exactly this key */
+      };
+
+      struct Entry {
+        ustring       name;
+        unsigned int  uses;
+        bool          present;
+      };
+
+      Node root;
+      std::vector<Entry> entries;
+      unsigned int present = 0;
+
+      static std::string key (const ustring &);
+      const Node * find (const std::string &) const;
+      int lookup (const ustring &) const;
+      void collect (const Node *, std::vector<int> &) const;
+  };
+}
+
@@ -6,6 +6,15 @@
 # include <iomanip>
 # include <exception>
 
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/stat.h>
+# ifdef __linux__
+  # include <sys/ioctl.h>
+  # include <sys/sendfile.h>
+  # include <linux/fs.h>
+# endif
+
 # include <glib.h>
 # include <boost/property_tree/ptree.hpp>
 # include <boost/filesystem.hpp>
@@ -46,7 +55,7 @@ namespace Astroid {
     if (tags_alpha < 0) tags_alpha = 0;
   }
 
-  ustring Utils::format_size (int sz) {
+  ustring Utils::format_size (guint64 sz) {
 
     /* Glib::format_size is not yet likely to be available */
 
@@ -71,6 +80,87 @@ namespace Astroid {
     return _f;
   }
 
+  bool Utils::copy_file (bfs::path from, bfs::path to) {
+    /* tries, in order: reflink (shared extents), copy_file_range and
+     * sendfile (copied in kernel), read and write. */
+    int in = open (from.c_str (), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+      LOG (error) << "utils: copy: could not open: " << from.c_str ();
+      return false;
+    }
+
+    struct stat st;
+    if (fstat (in, &st) < 0) {
+      close (in);
+      return false;
+    }
+
+    int out = open (to.c_str (), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+      LOG (error) << "utils: copy: could not open for writing: " << to.c_str ();
+      close (in);
+      return false;
+    }
+
+    off_t left = st.st_size;
+    bool  done = false;
+
+# if defined (__linux__) && defined (FICLONE)
+    if (ioctl (out, FICLONE, in) == 0) {
+      LOG (debug) << "utils: copy: reflinked: " << to.c_str ();
+      done = true;
+    }
+# endif
+
+# if defined (__linux__) && defined (__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+    while (!done && left > 0) {
+      ssize_t n = copy_file_range (in, NULL, out, NULL, left, 0);
+      if (n <= 0) break;
+      left -= n;
+    }
+
+    if (!done && left == 0) done = true;
+# endif
+
+# ifdef __linux__
+    while (!done && left > 0) {
+      ssize_t n = sendfile (out, in, NULL, left);
+      if (n <= 0) break;
+      left -= n;
+    }
+
+    if (!done && left == 0) done = true;
+# endif
+
+    if (!done) {
+      /* continue from where the kernel copy stopped */
+      char buf[64 * 1024];
+      off_t pos = st.st_size - left;
+
+      while (left > 0) {
+        ssize_t n = pread (in, buf, sizeof (buf), pos);
+        if (n <= 0) break;
+
+        ssize_t w = pwrite (out, buf, n, pos);
+        if (w != n) break;
+
+        pos  += n;
+        left -= n;
+      }
+
+      done = (left == 0);
+    }
+
+    close (in);
+    if (close (out) < 0) done = false;
+
+    if (!done) {
+      LOG (error) << "utils: copy: failed copying " << from.c_str () << " to " << to.c_str ();
+    }
+
+    return done;
+  }
+
   bfs::path Utils::expand (bfs::path in) {
     ustring s = in.c_str ();
     if (s.size () < 1) return in;
@@ -18,7 +18,7 @@ namespace Astroid {
       static void init ();
 
       /* return human readable file size */
-      static ustring format_size (int sz);
+      static ustring format_size (guint64 sz);
 
       /* make filename safe */
       static ustring safe_fname (ustring fname);
@@ -26,6 +26,9 @@ namespace Astroid {
       /* expand ~ to HOME */
       static bfs::path expand (bfs::path);
 
+      /* copy file, letting the kernel do the copying where possible */
+      static bool copy_file (bfs::path from, bfs::path to);
+
       /* get tag color */
       static std::pair<Gdk::RGBA, Gdk::RGBA> get_tag_color_rgba (ustring, guint8 canvascolor[3]);
       static std::pair<ustring, ustring> get_tag_color (ustring, guint8 canvascolor[3]);
@@ -0,0 +1,386 @@
+# include <iostream>
+# include <fstream>
+# include <random>
+# include <chrono>
+# include <vector>
+# include <functional>
+
+# include <boost/filesystem.hpp>
+# include <boost/program_options.hpp>
+# include <boost/property_tree/ptree.hpp>
+# include <boost/property_tree/json_parser.hpp>
+
+# include <gtkmm.h>
+
+# include "test_common.hh"
+
+# include "db.hh"
+# include "message_thread.hh"
+# include "poll.hh"
+# include "main_window.hh"
+# include "actions/tag_action.hh"
+# include "modes/thread_index/query_loader.hh"
+# include "modes/thread_index/thread_index_list_view.hh"
+# include "modes/thread_view/thread_view.hh"
+# include "modes/thread_view/page_client.hh"
+
+/*
+ * Benchmarks over a synthetic corpus.
+ *
+ * The corpus is generated deterministically from the seed by:
+ *
+ *   bench_astroid --generate <maildir> [--messages N] [--thread-depth D]
+ *                 [--attachments F] [--html F] [--seed S]
+ *
+ * after which it is indexed by notmuch and the benchmarks are run from
+ * the bench directory (see run_benchmark.sh). The results are written as
+ * json to stdout or to --output.
+ */
+
+namespace bfs = boost::filesystem;
+namespace po  = boost::program_options;
+namespace pt  = boost::property_tree;
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+using namespace Astroid;
+
+struct Corpus {
+  unsigned int messages     = 2000;
+  unsigned int thread_depth = 8;
+  double       attachments  = 0.1;
+  double       html         = 0.3;
+  unsigned int seed         = 42;
+};
+
+/* std::mt19937 is fully specified, the distributions are not: only use
+ * the raw output to stay reproducible across standard libraries. */
+class Rand {
+  public:
+    Rand (unsigned int seed) : g (seed) { }
+
+    unsigned int below (unsigned int n) { return g () % n; }
+    bool chance (double p) { return (g () % 10000) < (p * 10000); }
+
+    std::string word () {
+      static const char * words[] = {
+        "index", "thread", "message", "notmuch", "query", "tag", "render",
+        "patch", "reply", "build", "release", "mail", "view", "search",
+        "crypto", "attachment", "config", "the", "a", "of", "and", "is",
+      };
+
+      return words[below (sizeof (words) / sizeof (words[0]))];
+    }
+
+    std::string sentence (unsigned int n) {
+      std::string s;
+      for (unsigned int i = 0; i < n; i++) {
+        if (i > 0) s += " ";
+        s += word ();
+      }
+      return s;
+    }
+
+  private:
+    std::mt19937 g;
+};
+
+void generate (bfs::path maildir, const Corpus & c) {
+  Rand r (c.seed);
+
+  for (auto d : { "cur", "new", "tmp" }) {
+    bfs::create_directories (maildir / d);
+  }
+
+  const time_t base = 1500000000;
+
+  unsigned int n = 0;
+  unsigned int thread = 0;
+
+  while (n < c.messages) {
+    /* a thread is a chain of replies, each reply to a random earlier
+     * message no deeper than thread_depth */
+    unsigned int size = 1 + r.below (c.thread_depth * 2);
+    std::vector<unsigned int> depth;
+    std::vector<std::string>  mids;
+    std::string subject = r.sentence (4 + r.below (4));
+
+    for (unsigned int i = 0; i < size && n < c.messages; i++, n++) {
+      std::string mid = "bench." + std::to_string (n) + "@astroid.bench";
+
+      int parent = -1;
+      if (i > 0) {
+        parent = r.below (i);
+        while (parent > 0 && depth[parent] + 1 > c.thread_depth) parent--;
+      }
+
+      depth.push_back (parent >= 0 ? depth[parent] + 1 : 0);
+      mids.push_back (mid);
+
+      char date[64];
+      time_t t = base + n * 600;
+      strftime (date, sizeof (date), "%a, %d %b %Y %H:%M:%S +0000", gmtime (&t));
+
+      std::ofstream f ((maildir / "cur" / (std::to_string (n) + ".bench:2,")).c_str ());
+
+      f << "From: Sender " << (n % 97) << " <sender" << (n % 97) << "@astroid.bench>\n";
+      f << "To: Charlie Root <root@localhost>\n";
+      f << "Subject: " << (parent >= 0 ? "Re: " : "") << subject << "\n";
+      f << "Date: " << date << "\n";
+      f << "Message-ID: <" << mid << ">\n";
+      if (parent >= 0) {
+        f << "In-Reply-To: <" << mids[parent] << ">\n";
+        f << "References: <" << mids[0] << ">";
+        if (parent > 0) f << " <" << mids[parent] << ">";
+        f << "\n";
+      }
+      f << "MIME-Version: 1.0\n";
+
+      std::string text;
+      unsigned int paragraphs = 1 + r.below (6);
+      for (unsigned int p = 0; p < paragraphs; p++) {
+        text += r.sentence (10 + r.below (60)) + ".\n\n";
+      }
+
+      if (parent >= 0) {
+        text += "On some day, someone wrote:\n> " + r.sentence (20) + "\n> " + r.sentence (20) + "\n";
+      }
+
+      bool has_html = r.chance (c.html);
+      bool has_att  = r.chance (c.attachments);
+
+      std::string body;
+      std::string btype;
+
+      if (has_html) {
+        btype = "multipart/alternative; boundary=\"alt-" + std::to_string (n) + "\"";
+        body  = "--alt-" + std::to_string (n) + "\n";
+        body += "Content-Type: text/plain; charset=utf-8\n\n" + text + "\n";
+        body += "--alt-" + std::to_string (n) + "\n";
+        body += "Content-Type: text/html; charset=utf-8\n\n";
+        body += "<html><body><p>" + text + "</p><table><tr><td>" + r.sentence (8) + "</td></tr></table></body></html>\n";
+        body += "--alt-" + std::to_string (n) + "--\n";
+      } else {
+        btype = "text/plain; charset=utf-8";
+        body  = text;
+      }
+
+      if (has_att) {
+        f << "Content-Type: multipart/mixed; boundary=\"mix-" << n << "\"\n\n";
+        f << "--mix-" << n << "\n";
+        f << "Content-Type: " << btype << "\n\n" << body << "\n";
+        f << "--mix-" << n << "\n";
+        f << "Content-Type: application/octet-stream; name=\"data-" << n << ".bin\"\n";
+        f << "Content-Disposition: attachment; filename=\"data-" << n << ".bin\"\n";
+        f << "Content-Transfer-Encoding: base64\n\n";
+
+        static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        unsigned int lines = 16 + r.below (512);
+        for (unsigned int l = 0; l < lines; l++) {
+          for (int k = 0; k < 76; k++) f << b64[r.below (64)];
+          f << "\n";
+        }
+
+        f << "--mix-" << n << "--\n";
+      } else {
+        f << "Content-Type: " << btype << "\n\n" << body;
+      }
+    }
+
+    thread++;
+  }
+
+  cerr << "bench: generated " << n << " messages in " << thread << " threads in: " << maildir.c_str () << endl;
+}
+
+/* time a stage a number of times, f returns the number of items handled */
+pt::ptree measure (const char * name, unsigned int iterations, std::function<unsigned int ()> f) {
+  double min = 0, max = 0, total = 0;
+  unsigned int items = 0;
+
+  for (unsigned int i = 0; i < iterations; i++) {
+    auto t0 = std::chrono::steady_clock::now ();
+    items = f ();
+    double ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now () - t0).count ();
+
+    if (i == 0 || ms < min) min = ms;
+    if (ms > max) max = ms;
+    total += ms;
+  }
+
+  cerr << "bench: " << name << ": " << items << " items, mean: " << (total / iterations) << " ms." << endl;
+
+  pt::ptree s;
+  s.put ("iterations", iterations);
+  s.put ("items", items);
+  s.put ("min_ms", min);
+  s.put ("mean_ms", total / iterations);
+  s.put ("max_ms", max);
+
+  return s;
+}
+
+/* the page client is only reachable from a thread view */
+class BenchThreadView : public ThreadView {
+  public:
+    BenchThreadView (MainWindow * mw) : ThreadView (mw) { }
+
+    using ThreadView::page_client;
+};
+
+pt::ptree skipped (const char * reason) {
+  pt::ptree s;
+  s.put ("skipped", reason);
+  return s;
+}
+
+int main (int argc, char ** argv) {
+  Corpus c;
+  unsigned int iterations;
+
+  po::options_description desc ("options");
+  desc.add_options ()
+    ( "help,h", "print this help message")
+    ( "generate", po::value<std::string>(), "generate the synthetic corpus in this maildir and exit")
+    ( "messages", po::value<unsigned int>(&c.messages)->default_value (c.messages), "number of messages")
+    ( "thread-depth", po::value<unsigned int>(&c.thread_depth)->default_value (c.thread_depth), "maximum reply depth of a thread")
+    ( "attachments", po::value<double>(&c.attachments)->default_value (c.attachments), "fraction of messages with an attachment")
+    ( "html", po::value<double>(&c.html)->default_value (c.html), "fraction of messages with a html part")
+    ( "seed", po::value<unsigned int>(&c.seed)->default_value (c.seed), "seed for the corpus")
+    ( "iterations", po::value<unsigned int>(&iterations)->default_value (3), "number of times each stage is run")
+    ( "output,o", po::value<std::string>(), "write results to file instead of stdout");
+
+  po::variables_map vm;
+  po::store (po::parse_command_line (argc, argv, desc), vm);
+  po::notify (vm);
+
+  if (iterations == 0) iterations = 1;
+
+  if (vm.count ("help")) {
+    cout << desc << endl;
+    return 0;
+  }
+
+  if (vm.count ("generate")) {
+    generate (bfs::path (vm["generate"].as<std::string> ()), c);
+    return 0;
+  }
+
+  setup ();
+
+  pt::ptree res;
+  res.put ("corpus.messages", c.messages);
+  res.put ("corpus.thread_depth", c.thread_depth);
+  res.put ("corpus.attachments", c.attachments);
+  res.put ("corpus.html", c.html);
+  res.put ("corpus.seed", c.seed);
+
+  auto ctx = Glib::MainContext::get_default ();
+
+  /* full load of the index */
+  std::vector<refptr<NotmuchThread>> threads;
+
+  res.add_child ("results.query_load", measure ("query_load", iterations, [&] () {
+      /* a new loader every time, the previous one is released at the end
+       * of the iteration */
+      auto ql = QueryLoader::get ("*", QueryLoader::default_sort ());
+
+      /* the loader always emits after it is done */
+      while (ql->loading ()) ctx->iteration (true);
+
+      ql->stop ();
+      while (ctx->pending ()) ctx->iteration (false);
+
+      threads.clear ();
+      for (auto &row : ql->list_store->children ()) {
+        threads.push_back (row[ql->list_store->columns.thread]);
+      }
+
+      return ql->loaded_threads;
+    }));
+
+  /* loading the messages of every thread */
+  std::vector<refptr<MessageThread>> mthreads;
+
+  res.add_child ("results.load_messages", measure ("load_messages", iterations, [&] () {
+      mthreads.clear ();
+      unsigned int n = 0;
+
+      Db db (Db::DATABASE_READ_ONLY);
+      for (auto &t : threads) {
+        refptr<MessageThread> mt (new MessageThread (t));
+        mt->load_messages (&db);
+        n += mt->messages.size ();
+        mthreads.push_back (mt);
+      }
+      db.close ();
+
+      return n;
+    }));
+
+  /* building the messages sent to the web extension, needs a display */
+  if (gtk_init_check (NULL, NULL)) {
+    MainWindow * mw = new MainWindow ();
+    BenchThreadView * tv = new BenchThreadView (mw);
+
+    res.add_child ("results.make_message", measure ("make_message", iterations, [&] () {
+        unsigned int n = 0;
+
+        for (auto &mt : mthreads) {
+          for (auto &m : mt->messages) {
+            tv->page_client->make_message (m);
+            n++;
+          }
+          tv->state.clear ();
+        }
+
+        return n;
+      }));
+
+    delete tv;
+    delete mw;
+  } else {
+    res.add_child ("results.make_message", skipped ("no display"));
+  }
+
+  /* tagging all threads and back */
+  unsigned long revision;
+  {
+    Db db (Db::DATABASE_READ_ONLY);
+    revision = db.get_revision ();
+    db.close ();
+  }
+
+  res.add_child ("results.tag", measure ("tag", iterations, [&] () {
+      std::vector<refptr<NotmuchItem>> items (threads.begin (), threads.end ());
+
+      Db db (Db::DATABASE_READ_WRITE);
+      refptr<TagAction> add (new TagAction (items, { "bench" }, {}));
+      add->doit (&db);
+
+      refptr<TagAction> rem (new TagAction (items, {}, { "bench" }));
+      rem->doit (&db);
+      db.close ();
+
+      return items.size ();
+    }));
+
+  /* refreshing every thread changed by the tagging */
+  res.add_child ("results.poll_refresh", measure ("poll_refresh", iterations, [&] () {
+      astroid->poll->refresh (revision);
+      return threads.size ();
+    }));
+
+  if (vm.count ("output")) {
+    pt::write_json (vm["output"].as<std::string> (), res);
+  } else {
+    pt::write_json (cout, res);
+  }
+
+  teardown ();
+
+  return 0;
+}
+
@@ -0,0 +1,101 @@
+# include <iostream>
+# include <string>
+# include <chrono>
+# include <random>
+
+# include <gmime/gmime.h>
+# include "utils/gmime/gmime-compat.h"
+# include "utils/gmime/gmime-filter-html-bq.h"
+
+/*
+ * Throughput of the plain text to html filter with and without the fast
+ * path, on generated patch and log like text.
+ *
+ *   bench_html_filter [megabytes] [iterations]
+ */
+
+using std::cout;
+using std::endl;
+
+std::string make_patch (size_t size) {
+  std::mt19937 g (1);
+  std::string s;
+
+  const char * lines[] = {
+    "diff --git a/src/chunk.cc b/src/chunk.cc\n",
+    "@@ -300,12 +300,14 @@ namespace Astroid {\n",
+    "-        GMimeStream * filter_stream = g_mime_stream_filter_new (stream);\n",
+    "+        GMimeStream * filter_stream = g_mime_stream_filter_new (stream); // see https://github.com/astroidmail/astroid\n",
+    "         if (charset && std::string(charset) == \"utf-8\") {\n",
+    "> On Mon, someone <someone@example.com> wrote:\n",
+    ">> quoted text & more <quoted> text\n",
+    "2019-01-01 12:00:00.000 [info] db: opened database in 12 ms.\n",
+    "    \tindented\twith tabs\n",
+    "plain text of a normal paragraph that goes on for a while without anything special in it\n",
+  };
+
+  while (s.size () < size) {
+    s += lines[g () % (sizeof (lines) / sizeof (lines[0]))];
+  }
+
+  return s;
+}
+
+size_t run (const std::string & in, std::string & out) {
+  guint32 flags = GMIME_FILTER_HTML_CONVERT_NL |
+                  GMIME_FILTER_HTML_CONVERT_SPACES |
+                  GMIME_FILTER_HTML_CONVERT_URLS |
+                  GMIME_FILTER_HTML_CONVERT_ADDRESSES |
+                  GMIME_FILTER_HTML_BQ_BLOCKQUOTE_CITATION;
+
+  GMimeStream * mem = g_mime_stream_mem_new ();
+  GMimeStream * fs  = g_mime_stream_filter_new (mem);
+
+  GMimeFilter * f = g_mime_filter_html_bq_new (flags, 0x1e1e1e);
+  g_mime_stream_filter_add (GMIME_STREAM_FILTER (fs), f);
+  g_object_unref (f);
+
+  g_mime_stream_write (fs, in.c_str (), in.size ());
+  g_mime_stream_flush (fs);
+
+  GByteArray * res = g_mime_stream_mem_get_byte_array (GMIME_STREAM_MEM (mem));
+  out.assign ((const char *) res->data, res->len);
+
+  g_object_unref (fs);
+  g_object_unref (mem);
+
+  return out.size ();
+}
+
+int main (int argc, char ** argv) {
+  size_t mb         = argc > 1 ? std::stoul (argv[1]) : 16;
+  int    iterations = argc > 2 ? std::stoi (argv[2]) : 5;
+
+  g_mime_init ();
+
+  std::string in = make_patch (mb * 1024 * 1024);
+  std::string out_fast, out_slow;
+
+  for (int fast = 0; fast < 2; fast++) {
+    g_mime_filter_html_bq_set_fast_path (fast);
+
+    double best = 0;
+    for (int i = 0; i < iterations; i++) {
+      auto t0 = std::chrono::steady_clock::now ();
+      run (in, fast ? out_fast : out_slow);
+      double s = std::chrono::duration<double> (std::chrono::steady_clock::now () - t0).count ();
+
+      if (i == 0 || s < best) best = s;
+    }
+
+    cout << (fast ? "fast path: " : "byte by byte: ") << (in.size () / best / (1024 * 1024)) << " MB/s" << endl;
+  }
+
+  if (out_fast != out_slow) {
+    cout << "error: output differs between fast path and byte by byte." << endl;
+    return 1;
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,14 @@
+#! /usr/bin/env bash
+#
+# persistent quote processor speaking the framed protocol:
+#
+#   <length>\n<html>  ->  <length>\n<text>
+#
+
+export LC_ALL=C
+
+while read -r len; do
+  out=$(head -c "$len" | w3m -dump -T text/html)
+  printf '%d\n%s' "${#out}" "$out"
+done
+
@@ -0,0 +1,44 @@
+#! /usr/bin/env bash
+#
+# Generate the synthetic corpus, index it and run the benchmarks.
+#
+# usage: run_benchmark.sh SRCDIR BINDIR [bench_astroid options]
+#
+# the corpus options (--messages, --thread-depth, --attachments, --html and
+# --seed) are passed on to both the generator and the benchmark, the corpus
+# is regenerated every time.
+
+set -e
+
+SRCDIR="${1}"
+BINDIR="${2}"
+shift 2
+
+BENCHDIR="${BINDIR}/bench"
+corpus="${BENCHDIR}/tests/mail/corpus"
+
+export NOTMUCH_CONFIG="${BENCHDIR}/tests/mail/test_config"
+export GNUPGHOME="${BINDIR}/gnupg"
+export ASTROID_BUILD_DIR="${BINDIR}"
+
+echo "Source dir: ${SRCDIR}"
+echo "Bench dir:  ${BENCHDIR}"
+
+rm -rf "${BENCHDIR}"
+mkdir -p "${corpus}"
+
+cp "${SRCDIR}/tests/mail/test_config.template" "${NOTMUCH_CONFIG}"
+notmuch config set database.path "${corpus}"
+
+"${BINDIR}/tests/bench_astroid" --generate "${corpus}" "$@"
+notmuch new --quiet
+
+cp -r "${SRCDIR}/tests/test_home" "${BENCHDIR}/tests/"
+
+mkdir -p "${BENCHDIR}/ui"
+find "${SRCDIR}/ui/" \( -name "*.scss" -o -name "*.html" -o -name "*.css" \) -exec cp "{}" "${BENCHDIR}/ui/" \;
+
+pushd "${BENCHDIR}" > /dev/null
+"${BINDIR}/tests/bench_astroid" "$@"
+popd > /dev/null
+
@@ -51,6 +51,9 @@ if [ ! -e "${NOTMUCH_CONFIG}" ]; then
   find "${SRCDIR}/ui/" \( -name "*.scss" -o -name "*.html" -o -name "*.css" \) -exec cp -v "{}" "${BINDIR}/ui/" \;
 fi
 
+# helper scripts run by the tests, kept up to date with the source
+cp "${SRCDIR}/tests/quote_coprocess.sh" "${BINDIR}/tests/"
+
 echo "Running: ${TEST}.."
 
 pushd "${BINDIR}"
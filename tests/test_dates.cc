@@ -106,6 +106,29 @@ BOOST_AUTO_TEST_SUITE(Dates)
     teardown ();
   }
 
+  BOOST_AUTO_TEST_CASE(dates_cached_pretty_print)
+  {
+    setup ();
+
+    using Astroid::Date;
+
+    time_t now = time (NULL);
+
+    /* cached dates must match the uncached ones, also on the second lookup */
+    std::vector<time_t> offsets = { 0, 30, 5 * 60, 3 * 60 * 60, 20 * 60 * 60,
+                                    30 * 60 * 60, 4 * 24 * 60 * 60,
+                                    40 * 24 * 60 * 60, 400 * 24 * 60 * 60,
+                                    -60 * 60 };
+
+    for (int i = 0; i < 2; i++) {
+      for (auto o : offsets) {
+        time_t t = now - o;
+        BOOST_CHECK_EQUAL (Date::pretty_print_cached (t), Date::pretty_print (t));
+      }
+    }
+
+    teardown ();
+  }
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,124 @@
+# define BOOST_TEST_DYN_LINK
+# define BOOST_TEST_MODULE TestHtmlFilter
+# include <boost/test/unit_test.hpp>
+# include <gmime/gmime.h>
+# include "utils/gmime/gmime-compat.h"
+# include "utils/gmime/gmime-filter-html-bq.h"
+
+# include <string>
+# include <vector>
+# include <algorithm>
+
+# include "test_common.hh"
+
+/* the fast path of the plain text to html filter must give the same
+ * output as the byte by byte path. */
+
+std::string filter (const std::string & in, guint32 flags, bool fast, size_t piece) {
+  g_mime_filter_html_bq_set_fast_path (fast);
+
+  GMimeStream * mem = g_mime_stream_mem_new ();
+  GMimeStream * fs  = g_mime_stream_filter_new (mem);
+
+  GMimeFilter * f = g_mime_filter_html_bq_new (flags, 0x1e1e1e);
+  g_mime_stream_filter_add (GMIME_STREAM_FILTER (fs), f);
+  g_object_unref (f);
+
+  /* the filter also gets input that is cut in the middle of a line */
+  for (size_t i = 0; i < in.size (); i += piece) {
+    g_mime_stream_write (fs, in.c_str () + i, std::min (piece, in.size () - i));
+  }
+  g_mime_stream_flush (fs);
+
+  GByteArray * res = g_mime_stream_mem_get_byte_array (GMIME_STREAM_MEM (mem));
+  std::string out ((const char *) res->data, res->len);
+
+  g_object_unref (fs);
+  g_object_unref (mem);
+
+  g_mime_filter_html_bq_set_fast_path (true);
+
+  return out;
+}
+
+std::vector<std::string> edge_inputs () {
+  std::vector<std::string> inputs;
+
+  /* runs of spaces starting and ending around the 16 byte boundaries */
+  for (int start = 0; start < 34; start++) {
+    for (int len : { 1, 2, 3, 15, 16, 17, 32 }) {
+      inputs.push_back (std::string (start, 'a') + std::string (len, ' ') + "b\n");
+    }
+  }
+
+  /* characters that need escaping around the boundaries */
+  for (char c : { '<', '>', '&', '"', '\t' }) {
+    for (int pos = 0; pos < 34; pos++) {
+      std::string s (40, 'x');
+      s[pos] = c;
+      inputs.push_back (s + "\n");
+    }
+  }
+
+  /* non-ascii */
+  for (int pos = 0; pos < 34; pos++) {
+    inputs.push_back (std::string (pos, 'y') + "\xc3\xa6\xc3\xb8\xc3\xa5 \xe2\x80\x94 \xc3\xbcn\xc3\xafc\xc3\xb6" "d\xc3\xa9\n");
+  }
+
+  /* the line as a whole */
+  inputs.push_back ("");
+  inputs.push_back ("\n\n\n");
+  inputs.push_back ("   leading spaces and trailing spaces   \n");
+  inputs.push_back ("no newline at the end");
+  inputs.push_back ("> quoted & <escaped> \"text\"\n>> nested\n");
+  inputs.push_back ("see https://github.com/astroidmail/astroid or mail astroid@example.com.\n");
+  inputs.push_back ("a.b:c@d  e .  : @\n");
+
+  return inputs;
+}
+
+BOOST_AUTO_TEST_SUITE(HtmlFilter)
+
+  BOOST_AUTO_TEST_CASE(fast_path_matches_byte_by_byte)
+  {
+    setup ();
+
+    std::vector<guint32> flag_sets = {
+      GMIME_FILTER_HTML_CONVERT_NL,
+
+      GMIME_FILTER_HTML_CONVERT_NL |
+      GMIME_FILTER_HTML_CONVERT_SPACES,
+
+      GMIME_FILTER_HTML_CONVERT_NL |
+      GMIME_FILTER_HTML_CONVERT_SPACES |
+      GMIME_FILTER_HTML_CONVERT_URLS |
+      GMIME_FILTER_HTML_CONVERT_ADDRESSES |
+      GMIME_FILTER_HTML_BQ_BLOCKQUOTE_CITATION,
+    };
+
+    std::vector<std::string> inputs = edge_inputs ();
+
+    /* all of them after each other */
+    std::string all;
+    for (auto &i : inputs) all += i;
+    inputs.push_back (all);
+
+    for (guint32 flags : flag_sets) {
+      for (auto &in : inputs) {
+        for (size_t piece : { (size_t) 7, (size_t) 4096 }) {
+          std::string slow = filter (in, flags, false, piece);
+          std::string fast = filter (in, flags, true, piece);
+
+          if (fast != slow) {
+            LOG (error) << "html filter: output differs for: '" << in << "', flags: " << flags << ", pieces of: " << piece;
+          }
+
+          BOOST_CHECK (fast == slow);
+        }
+      }
+    }
+
+    teardown ();
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -107,5 +107,45 @@ BOOST_AUTO_TEST_SUITE(Markdown)
     teardown ();
   }
 
+  BOOST_AUTO_TEST_CASE(markdown_async_cached)
+  {
+    using Astroid::ComposeMessage;
+    setup ();
+
+    ustring bdy = "# This is a cached test";
+
+    /* not rendered before: built without html part */
+    ComposeMessage * c = new ComposeMessage ();
+    c->body << bdy;
+    c->markdown = true;
+    c->markdown_async = true;
+    c->build ();
+
+    BOOST_CHECK (c->markdown_pending);
+    BOOST_CHECK (!c->markdown_success);
+
+    ustring html, error;
+    BOOST_CHECK_MESSAGE (ComposeMessage::markdown_collect (c->markdown_pending_source, c->markdown_pending_result, html, error), error);
+
+    /* now cached, built with html part right away */
+    ComposeMessage * d = new ComposeMessage ();
+    d->body << bdy;
+    d->markdown = true;
+    d->markdown_async = true;
+    d->build ();
+
+    BOOST_CHECK (!d->markdown_pending);
+    BOOST_CHECK_MESSAGE (d->markdown_success, d->markdown_error);
+
+    std::string cached;
+    BOOST_CHECK (ComposeMessage::markdown_lookup (bdy, cached));
+    BOOST_CHECK (cached == std::string (html));
+
+    delete c;
+    delete d;
+
+    teardown ();
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
 
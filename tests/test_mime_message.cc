@@ -2,12 +2,14 @@
 # define BOOST_TEST_MODULE TestMimeMessage
 # include <boost/test/unit_test.hpp>
 # include <boost/filesystem.hpp>
+# include <fstream>
 
 # include "test_common.hh"
 # include "db.hh"
 # include "message_thread.hh"
 # include "compose_message.hh"
 # include "account_manager.hh"
+# include "chunk.hh"
 # include "glibmm.h"
 
 using namespace std;
@@ -69,6 +71,69 @@ BOOST_AUTO_TEST_SUITE(Reading)
 
   }
 
+  BOOST_AUTO_TEST_CASE (save_attachment_streamed)
+  {
+    using Astroid::Chunk;
+    setup ();
+
+    Message m ("tests/mail/test_mail/msg1.eml");
+    auto attachments = m.attachments ();
+    BOOST_REQUIRE (!attachments.empty ());
+
+    bfs::path dir = bfs::temp_directory_path () / bfs::unique_path ();
+    bfs::create_directories (dir);
+
+    for (auto a : attachments) {
+      bfs::path to = dir / bfs::path ("saved");
+
+      /* streamed output matches the in-memory contents */
+      BOOST_CHECK (a->save_to (to.c_str ()));
+
+      auto data = a->contents ();
+      std::ifstream f (to.c_str (), std::ios::binary);
+      std::string saved ((std::istreambuf_iterator<char> (f)), std::istreambuf_iterator<char> ());
+
+      BOOST_CHECK (saved == std::string (reinterpret_cast<char*> (data->get_data ()), data->size ()));
+
+      bfs::remove (to);
+
+      /* cancelling does not leave a partial file */
+      BOOST_CHECK (!a->save_to (to.c_str (), false, [] (gint64) { return false; }));
+      BOOST_CHECK (!bfs::exists (to));
+    }
+
+    bfs::remove_all (dir);
+
+    teardown ();
+  }
+
+  BOOST_AUTO_TEST_CASE (save_message_copy)
+  {
+    setup ();
+
+    ustring fname = "tests/mail/test_mail/msg1.eml";
+    Message m (fname);
+
+    std::ifstream f (fname.c_str (), std::ios::binary);
+    std::string orig ((std::istreambuf_iterator<char> (f)), std::istreambuf_iterator<char> ());
+
+    /* raw contents are read straight from the file */
+    auto d = m.raw_contents ();
+    BOOST_CHECK (orig == std::string (reinterpret_cast<char*> (d->get_data ()), d->size ()));
+
+    /* saving copies the file as is */
+    bfs::path to = bfs::temp_directory_path () / bfs::unique_path ();
+    m.save_to (to.c_str ());
+
+    std::ifstream g (to.c_str (), std::ios::binary);
+    std::string saved ((std::istreambuf_iterator<char> (g)), std::istreambuf_iterator<char> ());
+    BOOST_CHECK (orig == saved);
+
+    bfs::remove (to);
+
+    teardown ();
+  }
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -47,6 +47,42 @@ BOOST_AUTO_TEST_SUITE(DbTest)
     teardown ();
   }
 
+  BOOST_AUTO_TEST_CASE(thread_authors)
+  {
+    setup ();
+    const_cast<ptree&>(astroid->notmuch_config()).put ("database.path", "tests/mail/test_mail");
+
+    Db db (Db::DbMode::DATABASE_READ_ONLY);
+
+    notmuch_query_t * q = notmuch_query_create (db.nm_db, "*");
+    notmuch_threads_t * threads;
+    notmuch_status_t st = notmuch_query_search_threads (q, &threads);
+    BOOST_CHECK (st == NOTMUCH_STATUS_SUCCESS);
+
+    for (; notmuch_threads_valid (threads); notmuch_threads_move_to_next (threads)) {
+      notmuch_thread_t * t = notmuch_threads_get (threads);
+
+      /* the second load uses the cached author names */
+      refptr<NotmuchThread> a (new NotmuchThread (t));
+      refptr<NotmuchThread> b (new NotmuchThread (t));
+
+      BOOST_CHECK (a->authors == b->authors);
+
+      for (auto & au : a->authors) {
+        LOG (test) << a->thread_id << ": " << std::get<0> (au) << " (" << std::get<1> (au) << ")";
+
+        /* an unread author requires an unread thread */
+        BOOST_CHECK (!std::get<1> (au) || a->unread);
+      }
+
+      notmuch_thread_destroy (t);
+    }
+
+    notmuch_query_destroy (q);
+
+    teardown ();
+  }
+
   BOOST_AUTO_TEST_CASE(open_error)
   {
     setup ();
@@ -6,6 +6,7 @@
 # include "message_thread.hh"
 # include "utils/ustring_utils.hh"
 # include "config.hh"
+# include "utils/filter_process.hh"
 
 BOOST_AUTO_TEST_SUITE(QuoteHtml)
 
@@ -59,5 +60,56 @@ Reply to this email directly, view it on GitHub, or mute the thread.*)";
     teardown ();
   }
 
+  BOOST_AUTO_TEST_CASE(quote_html_persistent)
+  {
+    using Astroid::Message;
+    using Astroid::FilterProcess;
+    setup ();
+
+    ustring fname = "tests/mail/test_mail/only-html.eml";
+
+    ustring oneshot;
+    {
+      Message m (fname);
+      oneshot = m.quote ();
+      Astroid::UstringUtils::trim (oneshot);
+    }
+
+    /* co-process should give the same result, also when reused */
+    delete astroid->quote_processor;
+    astroid->quote_processor = new FilterProcess ("quote",
+        astroid->config ().get<std::string> ("mail.reply.quote_processor"),
+        "tests/quote_coprocess.sh", 5000);
+
+    for (int i = 0; i < 3; i++) {
+      Message m (fname);
+      ustring quoted = m.quote ();
+
+      Astroid::UstringUtils::trim (quoted);
+      BOOST_CHECK (quoted == oneshot);
+    }
+
+    /* and not through the one-shot fallback */
+    BOOST_CHECK_EQUAL (astroid->quote_processor->coprocess_conversions.load (), 3u);
+
+    /* falls back to one-shot when the co-process cannot be started */
+    delete astroid->quote_processor;
+    astroid->quote_processor = new FilterProcess ("quote",
+        astroid->config ().get<std::string> ("mail.reply.quote_processor"),
+        "does-not-exist-quote-processor", 5000);
+
+    {
+      Message m (fname);
+      ustring quoted = m.quote ();
+
+      Astroid::UstringUtils::trim (quoted);
+      BOOST_CHECK (quoted == oneshot);
+    }
+
+    BOOST_CHECK_EQUAL (astroid->quote_processor->coprocess_conversions.load (), 0u);
+
+    teardown ();
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
 
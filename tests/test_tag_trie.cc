@@ -0,0 +1,69 @@
+# define BOOST_TEST_DYN_LINK
+# define BOOST_TEST_MODULE TestTagTrie
+# include <boost/test/unit_test.hpp>
+
+# include "test_common.hh"
+# include "utils/tag_trie.hh"
+
+using Astroid::TagTrie;
+
+BOOST_AUTO_TEST_SUITE(TagTrieCompletion)
+
+  BOOST_AUTO_TEST_CASE(complete_prefix)
+  {
+    setup ();
+
+    TagTrie t;
+    t.update ({ "inbox", "important", "Info", "unread", "list-astroid" });
+
+    BOOST_CHECK_EQUAL (t.size (), 5);
+
+    std::vector<ustring> c = t.complete ("in", 10);
+    BOOST_CHECK_EQUAL (c.size (), 2);
+
+    c = t.complete ("inb", 10);
+    BOOST_CHECK_EQUAL (c.size (), 1);
+    BOOST_CHECK_EQUAL (c[0], "inbox");
+
+    /* case folded */
+    c = t.complete ("INF", 10);
+    BOOST_CHECK_EQUAL (c.size (), 1);
+    BOOST_CHECK_EQUAL (c[0], "Info");
+
+    BOOST_CHECK (t.complete ("x", 10).empty ());
+    BOOST_CHECK_EQUAL (t.complete ("", 2).size (), 2);
+
+    teardown ();
+  }
+
+  BOOST_AUTO_TEST_CASE(rank_by_use)
+  {
+    setup ();
+
+    TagTrie t;
+    t.update ({ "inbox", "important", "Info" });
+
+    t.use ("important");
+    t.use ("important");
+    t.use ("inbox");
+    t.use ("not-a-tag");
+
+    std::vector<ustring> c = t.complete ("i", 2);
+    BOOST_CHECK_EQUAL (c.size (), 2);
+    BOOST_CHECK_EQUAL (c[0], "important");
+    BOOST_CHECK_EQUAL (c[1], "inbox");
+
+    /* removed tags are hidden, but keep their uses when they return */
+    t.update ({ "inbox", "Info" });
+    BOOST_CHECK_EQUAL (t.size (), 2);
+    BOOST_CHECK_EQUAL (t.complete ("im", 10).size (), 0);
+
+    BOOST_CHECK (t.insert ("important"));
+    BOOST_CHECK (!t.insert ("important"));
+    BOOST_CHECK_EQUAL (t.complete ("i", 1)[0], "important");
+
+    teardown ();
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
+
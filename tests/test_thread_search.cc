@@ -0,0 +1,96 @@
+# define BOOST_TEST_DYN_LINK
+# define BOOST_TEST_MODULE TestThreadSearch
+# include <boost/test/unit_test.hpp>
+
+# include "test_common.hh"
+# include "message_thread.hh"
+# include "modes/thread_view/thread_search.hh"
+
+using Astroid::Message;
+using Astroid::MessageThread;
+using Astroid::ThreadSearch;
+
+BOOST_AUTO_TEST_SUITE(ThreadSearching)
+
+  BOOST_AUTO_TEST_CASE(search_parts_and_headers)
+  {
+    setup ();
+
+    refptr<MessageThread> mt = refptr<MessageThread> (new MessageThread ());
+    mt->add_message (ustring ("tests/mail/test_mail/msg1.eml"));
+    mt->add_message (ustring ("tests/mail/test_mail/msg2.eml"));
+
+    ThreadSearch s;
+
+    unsigned int n = s.search (mt, "xapian");
+    BOOST_CHECK (n > 0);
+    BOOST_CHECK (s.has_match (mt->messages[0]));
+    BOOST_CHECK (s.has_match (mt->messages[1]));
+
+    /* case insensitive */
+    BOOST_CHECK (s.search (mt, "XAPIAN") == n);
+
+    /* matches in the subject are header matches */
+    s.search (mt, "indexing messages without ruby");
+    BOOST_CHECK (s.matches.size () >= 2);
+    BOOST_CHECK (s.matches[0].chunk == -1);
+
+    /* stepping wraps around */
+    s.search (mt, "xapian");
+    s.seek (mt, mt->messages[1]);
+    BOOST_CHECK (s.current ()->message == mt->messages[1]);
+
+    for (unsigned int i = 0; i < n; i++) s.next ();
+    BOOST_CHECK (s.current ()->message == mt->messages[1]);
+
+    BOOST_CHECK (s.search (mt, "no such text in this thread") == 0);
+    BOOST_CHECK (s.next () == NULL);
+
+    teardown ();
+  }
+
+  BOOST_AUTO_TEST_CASE(search_html_entities)
+  {
+    setup ();
+
+    refptr<MessageThread> mt = refptr<MessageThread> (new MessageThread ());
+    mt->add_message (ustring ("tests/mail/test_mail/only-html.eml"));
+
+    ThreadSearch s;
+
+    /* entities are matched as the text they stand for */
+    BOOST_CHECK (s.search (mt, "\u2014 You are receiving") > 0);
+    BOOST_CHECK (s.search (mt, "&mdash;") == 0);
+
+    /* tags are not */
+    BOOST_CHECK (s.search (mt, "<li>") == 0);
+    BOOST_CHECK (s.search (mt, "save as draft") > 0);
+
+    teardown ();
+  }
+
+  BOOST_AUTO_TEST_CASE(search_html_hidden_and_boundaries)
+  {
+    setup ();
+
+    refptr<MessageThread> mt = refptr<MessageThread> (new MessageThread ());
+    mt->add_message (ustring ("tests/mail/test_mail/html-style.eml"));
+
+    ThreadSearch s;
+
+    /* style, script and comments are not shown */
+    BOOST_CHECK (s.search (mt, "monospace") == 0);
+    BOOST_CHECK (s.search (mt, "trackingvalue") == 0);
+    BOOST_CHECK (s.search (mt, "comment") == 0);
+
+    /* block tags separate words, inline tags do not */
+    BOOST_CHECK (s.search (mt, "paragraphsecond") == 0);
+    BOOST_CHECK (s.search (mt, "paragraph second") > 0);
+    BOOST_CHECK (s.search (mt, "blockone") == 0);
+    BOOST_CHECK (s.search (mt, "oneboldword") > 0);
+
+    teardown ();
+  }
+
+BOOST_AUTO_TEST_SUITE_END()
+